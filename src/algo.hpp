@@ -3,6 +3,17 @@
 #define ALGO_HPP_INCLUDED
 
 #include <algorithm>    // std::find_if, std::transform
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "simd.hpp"
+#include "threads/thread_pool.hpp"
 
 /*---------------------------------------------------------------------------75*/
 /**
@@ -18,6 +29,401 @@ namespace utils
 {
     namespace algo
     {
+        namespace execution
+        {
+            /**
+             @brief Execution policies for the algorithms in utils::algo,
+             like those of C++17's <execution>.
+             */
+            struct sequenced_policy {};
+            struct parallel_policy {};
+            struct parallel_unsequenced_policy {};
+            
+            constexpr sequenced_policy seq{};
+            constexpr parallel_policy par{};
+            constexpr parallel_unsequenced_policy par_unseq{};
+            
+            template<typename T>
+            struct is_execution_policy : public std::false_type {};
+            
+            template<>
+            struct is_execution_policy<sequenced_policy> : public std::true_type {};
+            
+            template<>
+            struct is_execution_policy<parallel_policy> : public std::true_type {};
+            
+            template<>
+            struct is_execution_policy<parallel_unsequenced_policy> : public std::true_type {};
+        } // end namespace utils.algo.execution
+        
+        namespace detail
+        {
+            /**
+             @brief Tags for comparisons of two integers of which only the
+             first or only the second is signed.
+             */
+            struct signed_unsigned {};
+            struct unsigned_signed {};
+            
+            template<typename A, typename B>
+            using comparison_tag = typename std::conditional<
+                !std::is_integral<A>::value || !std::is_integral<B>::value ||
+                std::is_signed<A>::value == std::is_signed<B>::value,
+                std::false_type,
+                typename std::conditional<std::is_signed<A>::value,
+                    signed_unsigned, unsigned_signed>::type>::type;
+            
+            template<typename A, typename B>
+            bool compare_less(const A& a, const B& b, std::false_type)
+            {
+                return a < b;
+            }
+            
+            template<typename A, typename B>
+            bool compare_less(const A& a, const B& b, signed_unsigned)
+            {
+                return a < A(0) || static_cast<typename std::make_unsigned<A>::type>(a) < b;
+            }
+            
+            template<typename A, typename B>
+            bool compare_less(const A& a, const B& b, unsigned_signed)
+            {
+                return !(b < B(0)) && a < static_cast<typename std::make_unsigned<B>::type>(b);
+            }
+            
+            template<typename A, typename B>
+            bool compare_equal(const A& a, const B& b, std::false_type)
+            {
+                return a == b;
+            }
+            
+            template<typename A, typename B>
+            bool compare_equal(const A& a, const B& b, signed_unsigned)
+            {
+                return !(a < A(0)) && static_cast<typename std::make_unsigned<A>::type>(a) == b;
+            }
+            
+            template<typename A, typename B>
+            bool compare_equal(const A& a, const B& b, unsigned_signed)
+            {
+                return !(b < B(0)) && a == static_cast<typename std::make_unsigned<B>::type>(b);
+            }
+            
+            /**
+             @brief a < b and a == b for arithmetic types without narrowing
+             either operand: mixed integer and floating-point operands are
+             compared as floating-point numbers, and negative signed integers
+             are less than all unsigned integers.
+             */
+            template<typename A, typename B>
+            bool compare_less(const A& a, const B& b)
+            {
+                return compare_less(a, b, comparison_tag<A, B>());
+            }
+            
+            template<typename A, typename B>
+            bool compare_equal(const A& a, const B& b)
+            {
+                return compare_equal(a, b, comparison_tag<A, B>());
+            }
+        } // end namespace utils.algo.detail
+        
+        /**
+         @brief Predicate comparing an element with constants: value < low,
+         value == low, or low <= value < high, depending on Kind.
+         @details Elements of any type are compared with the constants
+         without converting them to T. copy_index_if recognizes these
+         predicates and, for float, double, int32_t and int64_t elements of
+         contiguous ranges (pointers and std::vector iterators) whose value
+         type is T, selects the indices with the vectorized
+         simd::select_indices.
+         */
+        template<typename T, simd::comparison Kind>
+        struct comparison_predicate
+        {
+            T mLow;
+            T mHigh;
+            
+            template<typename U>
+            bool operator()(const U& value) const
+            {
+                switch (Kind) {
+                    case simd::comparison::less: return detail::compare_less(value, mLow);
+                    case simd::comparison::equal: return detail::compare_equal(value, mLow);
+                    case simd::comparison::in_range:
+                        return !detail::compare_less(value, mLow) &&
+                            detail::compare_less(value, mHigh);
+                }
+                return false;
+            }
+        };
+        
+        template<typename T>
+        comparison_predicate<T, simd::comparison::less> less_than(const T& value)
+        {
+            return {value, value};
+        }
+        
+        template<typename T>
+        comparison_predicate<T, simd::comparison::equal> equal_to(const T& value)
+        {
+            return {value, value};
+        }
+        
+        /**
+         @brief Returns a predicate for the half-open range [low,high).
+         */
+        template<typename T>
+        comparison_predicate<T, simd::comparison::in_range> in_range(const T& low, const T& high)
+        {
+            return {low, high};
+        }
+        
+        namespace detail
+        {
+            template<typename ExecutionPolicy, typename T>
+            using enable_if_execution_policy = std::enable_if<
+                execution::is_execution_policy<typename std::decay<ExecutionPolicy>::type>::value,
+                T>;
+            
+            template<typename Iterator>
+            using is_random_access = std::is_base_of<
+                std::random_access_iterator_tag,
+                typename std::iterator_traits<Iterator>::iterator_category>;
+            
+            /**
+             @brief Minimal number of elements per chunk of a parallel
+             algorithm, below which splitting costs more than it gains.
+             */
+            constexpr std::size_t min_chunk_size = 1 << 14;
+            
+            /**
+             @brief Returns the number of chunks to split size elements into
+             for the default thread pool: a few per thread, so that uneven
+             chunks balance out, but none smaller than min_chunk_size.
+             */
+            inline std::size_t chunk_count(const std::size_t size)
+            {
+                const std::size_t threads = threads::default_pool().size() + 1;
+                return std::max<std::size_t>(
+                    1, std::min(size / min_chunk_size, 4 * threads));
+            }
+            
+            /**
+             @brief Returns the first index of chunk of size elements split
+             into chunks chunks of (nearly) equal size.
+             */
+            inline std::size_t chunk_begin(
+                const std::size_t size,
+                const std::size_t chunks,
+                const std::size_t chunk)
+            {
+                return size / chunks * chunk + std::min(chunk, size % chunks);
+            }
+            
+            /**
+             @brief Stream compaction of size elements in chunks: calls
+             count(begin, end) for each chunk [begin,end) to get its number
+             of matching elements, and then scatter(begin, end, position),
+             where position is the number of matching elements before the
+             chunk. Returns the number of matching elements.
+             @details Counts the chunks in parallel, computes the output
+             offsets of the chunks as prefix sums of the counts, and
+             scatters the chunks in parallel.
+             */
+            template<typename Count, typename Scatter>
+            std::size_t parallel_compact_chunks(
+                const std::size_t size,
+                Count&& count,
+                Scatter&& scatter)
+            {
+                const std::size_t chunks = chunk_count(size);
+                std::vector<std::size_t> offsets(chunks + 1, 0);
+                threads::default_pool().parallel_for(chunks, [&] (const std::size_t chunk) {
+                    offsets[chunk + 1] = count(chunk_begin(size, chunks, chunk),
+                                                  chunk_begin(size, chunks, chunk + 1));
+                });
+                std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+                threads::default_pool().parallel_for(chunks, [&] (const std::size_t chunk) {
+                    scatter(chunk_begin(size, chunks, chunk), chunk_begin(size, chunks, chunk + 1),
+                            offsets[chunk]);
+                });
+                return offsets[chunks];
+            }
+            
+            /**
+             @brief Stream compaction of the size elements starting at first:
+             calls scatter(position, index) for the index of each element
+             satisfying pred, where position is the number of matching
+             elements before it. Returns the number of matching elements.
+             @details pred is called twice per element (see
+             parallel_compact_chunks), and must not have side effects.
+             */
+            template<typename RandomIt, typename UnaryPredicate, typename Scatter>
+            std::size_t parallel_compact(
+                RandomIt first,
+                const std::size_t size,
+                UnaryPredicate& pred,
+                Scatter&& scatter)
+            {
+                return parallel_compact_chunks(
+                    size,
+                    [first, &pred] (const std::size_t begin, const std::size_t end) {
+                        std::size_t count = 0;
+                        for (std::size_t i = begin; i < end; ++i) {
+                            if (pred(first[i])) { ++count; }
+                        }
+                        return count;
+                    },
+                    [first, &pred, &scatter] (const std::size_t begin, const std::size_t end,
+                                              std::size_t position) {
+                        for (std::size_t i = begin; i < end; ++i) {
+                            if (pred(first[i])) { scatter(position++, i); }
+                        }
+                    });
+            }
+            
+            /**
+             @brief Whether copy_index_if over [Iterator,Iterator) with
+             Predicate, writing indices of type Index, uses
+             simd::select_indices.
+             */
+            template<typename Iterator, typename Predicate, typename Index>
+            struct is_simd_selection : public std::false_type {};
+            
+            template<typename Iterator, typename T, simd::comparison Kind, typename Index>
+            struct is_simd_selection<Iterator, comparison_predicate<T, Kind>, Index>
+            : public std::integral_constant<bool,
+                simd::is_simd_type<T>::value && std::is_integral<Index>::value &&
+                (std::is_same<Iterator, T*>::value ||
+                 std::is_same<Iterator, const T*>::value ||
+                 std::is_same<Iterator, typename std::vector<T>::iterator>::value ||
+                 std::is_same<Iterator, typename std::vector<T>::const_iterator>::value)> {};
+            
+            /**
+             @brief Number of indices selected per call of
+             simd::select_indices, staged in a buffer on the stack.
+             */
+            constexpr std::size_t select_block_size = 1024;
+            
+            /**
+             @brief Calls emit(i), in increasing order, for each i in
+             [begin,end) for which data[i] satisfies pred.
+             */
+            template<typename T, simd::comparison Kind, typename Emit>
+            void select_indices(
+                const T* data,
+                std::size_t begin,
+                const std::size_t end,
+                const comparison_predicate<T, Kind>& pred,
+                Emit&& emit)
+            {
+                std::uint64_t buffer[select_block_size + simd::select_slack];
+                while (begin < end) {
+                    const std::size_t block = std::min(end - begin, select_block_size);
+                    const std::size_t count = simd::select_indices(
+                        data + begin, block, Kind, pred.mLow, pred.mHigh, begin, buffer);
+                    for (std::size_t j = 0; j < count; ++j) {
+                        emit(static_cast<std::size_t>(buffer[j]));
+                    }
+                    begin += block;
+                }
+            }
+            
+            template<typename T, simd::comparison Kind>
+            std::size_t count_matches(
+                const T* data,
+                const std::size_t begin,
+                const std::size_t end,
+                const comparison_predicate<T, Kind>& pred)
+            {
+                return simd::count_matches(data + begin, end - begin, Kind, pred.mLow, pred.mHigh);
+            }
+            
+            template<typename InputIt, typename OutputIt, typename UnaryPredicate, typename index_t>
+            void copy_index_if(
+                std::false_type /* simd */,
+                InputIt& input_begin,
+                InputIt& input_end,
+                OutputIt& output,
+                UnaryPredicate& predicate,
+                index_t& index)
+            {
+                while (input_begin != input_end)
+                {
+                    if (predicate(*input_begin))
+                    {
+                        *output++ = index;
+                    }
+                    ++index;
+                    ++input_begin;
+                }
+            }
+            
+            template<typename InputIt, typename OutputIt, typename UnaryPredicate, typename index_t>
+            void copy_index_if(
+                std::true_type /* simd */,
+                InputIt& input_begin,
+                InputIt& input_end,
+                OutputIt& output,
+                UnaryPredicate& predicate,
+                index_t& index)
+            {
+                using index_type = typename std::remove_const<index_t>::type;
+                const std::size_t size = static_cast<std::size_t>(input_end - input_begin);
+                if (size > 0) {
+                    const index_type first_index = index;
+                    select_indices(&*input_begin, 0, size, predicate,
+                                   [&output, first_index] (const std::size_t i) {
+                        *output++ = static_cast<index_type>(first_index + static_cast<index_type>(i));
+                    });
+                }
+                index += static_cast<index_type>(size);
+                input_begin = input_end;
+            }
+            
+            template<typename RandomIt, typename RandomOutIt, typename UnaryPredicate, typename index_t>
+            std::size_t parallel_copy_index_if(
+                std::false_type /* simd */,
+                RandomIt first,
+                const std::size_t size,
+                RandomOutIt output,
+                UnaryPredicate& predicate,
+                const index_t index)
+            {
+                return parallel_compact(
+                    first, size, predicate,
+                    [output, index] (const std::size_t position, const std::size_t i) {
+                        output[position] = static_cast<index_t>(index + i);
+                    });
+            }
+            
+            template<typename RandomIt, typename RandomOutIt, typename UnaryPredicate, typename index_t>
+            std::size_t parallel_copy_index_if(
+                std::true_type /* simd */,
+                RandomIt first,
+                const std::size_t size,
+                RandomOutIt output,
+                UnaryPredicate& predicate,
+                const index_t index)
+            {
+                if (size == 0) { return 0; }
+                const auto data = &*first;
+                return parallel_compact_chunks(
+                    size,
+                    [data, &predicate] (const std::size_t begin, const std::size_t end) {
+                        return count_matches(data, begin, end, predicate);
+                    },
+                    [data, &predicate, output, index] (const std::size_t begin, const std::size_t end,
+                                                       std::size_t position) {
+                        select_indices(data, begin, end, predicate,
+                                       [output, index, &position] (const std::size_t i) {
+                            output[position++] = static_cast<index_t>(index + i);
+                        });
+                    });
+            }
+        } // end namespace utils.algo.detail
+        
         /**
          @brief Finds the first element in the range [first,last) satisfying 
          the given binary predicate on the element's index and value. Returns 
@@ -34,7 +440,7 @@ namespace utils
             InputIterator last,
             BinaryPredicate pred)
         {
-            unsigned int index = 0;
+            std::size_t index = 0;
             return
                 std::find_if(
                     first, last,
@@ -46,6 +452,49 @@ namespace utils
                 );
         }
         
+        /**
+         @brief find_if_with_index with an execution policy. With a parallel
+         policy, the chunks of the range are searched in parallel, and the
+         first match is returned, like the sequential find_if_with_index.
+         @details The smallest index of a match found so far is shared
+         between the chunks: a chunk stops at it, and chunks starting
+         beyond it are skipped. pred may therefore be called for elements
+         after the first match, but not for elements after the last chunk
+         that was already being searched when the first match was found.
+         */
+        template<typename ExecutionPolicy, typename RandomIt, typename BinaryPredicate>
+        typename detail::enable_if_execution_policy<ExecutionPolicy, RandomIt>::type
+        find_if_with_index(
+            ExecutionPolicy&& /* policy */,
+            RandomIt first,
+            RandomIt last,
+            BinaryPredicate pred)
+        {
+            static_assert(
+                detail::is_random_access<RandomIt>::value,
+                "find_if_with_index with an execution policy requires random access iterators");
+            if (std::is_same<typename std::decay<ExecutionPolicy>::type,
+                             execution::sequenced_policy>::value) {
+                return find_if_with_index(first, last, pred);
+            }
+            const std::size_t size = static_cast<std::size_t>(last - first);
+            const std::size_t chunks = detail::chunk_count(size);
+            std::atomic<std::size_t> found(size);
+            threads::default_pool().parallel_for(chunks, [&] (const std::size_t chunk) {
+                const std::size_t end = detail::chunk_begin(size, chunks, chunk + 1);
+                for (std::size_t i = detail::chunk_begin(size, chunks, chunk);
+                     i < std::min(end, found.load(std::memory_order_relaxed)); ++i) {
+                    if (pred(i, first[i])) {
+                        std::size_t best = found.load(std::memory_order_relaxed);
+                        while (i < best &&
+                               !found.compare_exchange_weak(best, i, std::memory_order_relaxed)) {}
+                        return;
+                    }
+                }
+            });
+            return first + found.load();
+        }
+        
         /**
          @brief Applies the given unary operation sequentially to elements in 
          the range [first,last) that satisfy the given unary predicate and 
@@ -73,6 +522,56 @@ namespace utils
             }
             return result;
         }
+        
+        /**
+         @brief transform_if with an execution policy. With a parallel
+         policy, the elements are filtered as a parallel stream compaction
+         (see detail::parallel_compact) into the same output as the
+         sequential transform_if: pred must not have side effects, and
+         unary_op is called once per matching element, in any order.
+         */
+        template<
+            typename ExecutionPolicy,
+            typename RandomIt,
+            typename RandomOutIt,
+            typename UnaryPredicate,
+            typename UnaryOperation
+        >
+        typename detail::enable_if_execution_policy<ExecutionPolicy, RandomOutIt>::type
+        transform_if(
+            ExecutionPolicy&& /* policy */,
+            RandomIt first,
+            RandomIt last,
+            RandomOutIt result,
+            UnaryPredicate pred,
+            UnaryOperation unary_op)
+        {
+            static_assert(
+                detail::is_random_access<RandomIt>::value &&
+                detail::is_random_access<RandomOutIt>::value,
+                "transform_if with an execution policy requires random access iterators");
+            if (std::is_same<typename std::decay<ExecutionPolicy>::type,
+                             execution::sequenced_policy>::value) {
+                return transform_if(first, last, result, pred, unary_op);
+            }
+            const std::size_t count = detail::parallel_compact(
+                first, static_cast<std::size_t>(last - first), pred,
+                [first, result, &unary_op] (const std::size_t position, const std::size_t index) {
+                    result[position] = unary_op(first[index]);
+                });
+            return result + count;
+        }
+        
+       /**
+        @brief Writes index + i to output for each position i in the range
+        [input_begin,input_end) whose element satisfies predicate, in
+        increasing order of i. If index is an lvalue, it is advanced by
+        the size of the range.
+        @details For a comparison_predicate (less_than, equal_to, in_range)
+        on a contiguous range of its value type and an integral index, the
+        indices are selected with vectorized compare-and-compress kernels
+        (see simd::select_indices).
+        */
        
        template <typename InputIt, typename OutputIt, typename UnaryPredicate, typename index_t>
        void copy_index_if(InputIt&& input_begin,
@@ -81,15 +580,52 @@ namespace utils
                           UnaryPredicate&& predicate,
                           index_t&& index=index_t{})
        {
-          while (input_begin != input_end)
-          {
-             if (predicate(*input_begin))
-             {
-                *output++ = index++;
-             }
-             ++input_begin;
-          }
+          detail::copy_index_if(
+             detail::is_simd_selection<typename std::decay<InputIt>::type,
+                                       typename std::decay<UnaryPredicate>::type,
+                                       typename std::decay<index_t>::type>{},
+             input_begin, input_end, output, predicate, index);
        }
+        
+        /**
+         @brief copy_index_if with an execution policy, which returns the
+         end of the output. With a parallel policy, the indices are
+         written by a parallel stream compaction (see
+         detail::parallel_compact) in the same order as the sequential
+         copy_index_if. predicate must not have side effects.
+         */
+        template<
+            typename ExecutionPolicy,
+            typename RandomIt,
+            typename RandomOutIt,
+            typename UnaryPredicate,
+            typename index_t=std::size_t
+        >
+        typename detail::enable_if_execution_policy<ExecutionPolicy, RandomOutIt>::type
+        copy_index_if(
+            ExecutionPolicy&& /* policy */,
+            RandomIt first,
+            RandomIt last,
+            RandomOutIt output,
+            UnaryPredicate predicate,
+            const index_t index=index_t{})
+        {
+            static_assert(
+                detail::is_random_access<RandomIt>::value &&
+                detail::is_random_access<RandomOutIt>::value,
+                "copy_index_if with an execution policy requires random access iterators");
+            if (std::is_same<typename std::decay<ExecutionPolicy>::type,
+                             execution::sequenced_policy>::value) {
+                RandomOutIt end = output;
+                index_t next_index = index;
+                copy_index_if(first, last, end, predicate, next_index);
+                return end;
+            }
+            const std::size_t count = detail::parallel_copy_index_if(
+                detail::is_simd_selection<RandomIt, UnaryPredicate, index_t>{},
+                first, static_cast<std::size_t>(last - first), output, predicate, index);
+            return output + count;
+        }
     } // end namespace utils.algo
 } // end namespace utils
 
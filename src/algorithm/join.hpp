@@ -0,0 +1,222 @@
+#pragma once
+
+#include <boost/optional.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <utility>
+
+//--------------------------------------------------------------------------------------------------
+/// @file join.hpp
+/// @brief Joins of the values mapped to by the same keys in several maps, or in sorted ranges of
+/// pairs, calling a function per joined key instead of building a joined container.
+/// @details The hash joins accept std::unordered_maps, datastructures::flat_hash_maps and other
+/// maps with find. Values that are missing from a map are passed as empty
+/// boost::optional<const T&>s. No function copies keys or values or allocates memory.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace algorithm {
+namespace detail {
+
+template <typename Map>
+using optional_value_t = boost::optional<const typename Map::mapped_type&>;
+
+template <typename Map, typename Key>
+optional_value_t<Map> find_optional(const Map& map, const Key& key)
+{
+   const auto mapping = map.find(key);
+   return mapping == map.end() ? optional_value_t<Map>() : optional_value_t<Map>(mapping->second);
+}
+
+template <typename Function, typename Key, typename Values, std::size_t... Indices>
+void apply_zipped(Function& function,
+                  const Key& key,
+                  const Values& values,
+                  std::index_sequence<Indices...>)
+{
+   function(key, std::get<Indices>(values)...);
+}
+
+template <typename Function, typename Key, typename... Values>
+void zip_found(Function& function, const Key& key, const std::tuple<const Values&...>& values)
+{
+   apply_zipped(function, key, values, std::index_sequence_for<Values...>{});
+}
+
+/// @brief Looks key up in the remaining maps, adding the values to values, and calls function
+/// if all maps have key.
+template <typename Function, typename Key, typename... Values, typename Map, typename... Maps>
+void zip_found(Function& function,
+               const Key& key,
+               const std::tuple<const Values&...>& values,
+               const Map& map,
+               const Maps&... maps)
+{
+   const auto mapping = map.find(key);
+   if (mapping == map.end())
+      return;
+   zip_found(function, key,
+             std::tuple_cat(values, std::tuple<const typename Map::mapped_type&>(mapping->second)),
+             maps...);
+}
+
+}   // end namespace detail
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Calls function(key, value1, value2) for each key that map1 and map2 share, iterating
+/// over the smaller map and looking the keys up in the larger one.
+
+template <typename Map1, typename Map2, typename Function>
+void inner_join(const Map1& map1, const Map2& map2, Function&& function)
+{
+   if (map1.size() <= map2.size())
+   {
+      for (const auto& mapping1 : map1)
+      {
+         const auto mapping2 = map2.find(mapping1.first);
+         if (mapping2 != map2.end())
+            function(mapping1.first, mapping1.second, mapping2->second);
+      }
+   }
+   else
+   {
+      for (const auto& mapping2 : map2)
+      {
+         const auto mapping1 = map1.find(mapping2.first);
+         if (mapping1 != map1.end())
+            function(mapping1->first, mapping1->second, mapping2.second);
+      }
+   }
+}
+
+/// @brief Calls function(key, value1, optional value2) for each key in map1.
+
+template <typename Map1, typename Map2, typename Function>
+void left_join(const Map1& map1, const Map2& map2, Function&& function)
+{
+   for (const auto& mapping1 : map1)
+      function(mapping1.first, mapping1.second, detail::find_optional(map2, mapping1.first));
+}
+
+/// @brief Calls function(key, optional value1, optional value2) for each key in map1 or map2:
+/// first for the keys of map1, then for the keys that only map2 has.
+
+template <typename Map1, typename Map2, typename Function>
+void outer_join(const Map1& map1, const Map2& map2, Function&& function)
+{
+   for (const auto& mapping1 : map1)
+      function(mapping1.first, detail::optional_value_t<Map1>(mapping1.second),
+               detail::find_optional(map2, mapping1.first));
+   for (const auto& mapping2 : map2)
+   {
+      if (map1.find(mapping2.first) == map1.end())
+         function(mapping2.first, detail::optional_value_t<Map1>(),
+                  detail::optional_value_t<Map2>(mapping2.second));
+   }
+}
+
+/// @brief Calls function(key, value, values...) for each key of map that all maps have, with the
+/// values mapped to by key in map, maps..., in that order.
+
+template <typename Function, typename Map, typename... Maps>
+void zip_maps(Function&& function, const Map& map, const Maps&... maps)
+{
+   for (const auto& mapping : map)
+      detail::zip_found(function, mapping.first,
+                        std::tuple<const typename Map::mapped_type&>(mapping.second), maps...);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Calls function(key, value1, value2) for each pair of elements of [first1,last1) and
+/// [first2,last2) with equivalent keys, in key order. The ranges hold pairs of key and value
+/// sorted by key with compare. For keys that occur several times, function is called for all
+/// combinations.
+/// @details Merges the ranges in one pass, without hashing or lookups. Runs of equivalent keys in
+/// the second range are traversed once per element of the run in the first range.
+
+template <typename InputIt1, typename ForwardIt2, typename Function,
+          typename Compare = std::less<>>
+void merge_join(InputIt1 first1,
+                const InputIt1 last1,
+                ForwardIt2 first2,
+                const ForwardIt2 last2,
+                Function&& function,
+                Compare compare = Compare())
+{
+   while (first1 != last1 && first2 != last2)
+   {
+      if (compare(first1->first, first2->first))
+      {
+         ++first1;
+      }
+      else if (compare(first2->first, first1->first))
+      {
+         ++first2;
+      }
+      else
+      {
+         // Pair the run of equivalent keys in range 2 with each element of the run in range 1
+         ForwardIt2 run_end2 = first2;
+         for (; first1 != last1 && !compare(first2->first, first1->first); ++first1)
+         {
+            for (run_end2 = first2;
+                 run_end2 != last2 && !compare(first1->first, run_end2->first); ++run_end2)
+               function(first1->first, first1->second, run_end2->second);
+         }
+         first2 = run_end2;
+      }
+   }
+}
+
+/// @brief Calls function(key, optional value1, optional value2) for each key in [first1,last1)
+/// or [first2,last2), in key order, like merge_join, but also for the elements without a match
+/// in the other range.
+
+template <typename InputIt1, typename ForwardIt2, typename Function,
+          typename Compare = std::less<>>
+void merge_outer_join(InputIt1 first1,
+                      const InputIt1 last1,
+                      ForwardIt2 first2,
+                      const ForwardIt2 last2,
+                      Function&& function,
+                      Compare compare = Compare())
+{
+   using value1_t = boost::optional<const decltype(first1->second)&>;
+   using value2_t = boost::optional<const decltype(first2->second)&>;
+   while (first1 != last1 || first2 != last2)
+   {
+      if (first2 == last2 || (first1 != last1 && compare(first1->first, first2->first)))
+      {
+         function(first1->first, value1_t(first1->second), value2_t());
+         ++first1;
+      }
+      else if (first1 == last1 || compare(first2->first, first1->first))
+      {
+         function(first2->first, value1_t(), value2_t(first2->second));
+         ++first2;
+      }
+      else
+      {
+         ForwardIt2 run_end2 = first2;
+         for (; first1 != last1 && !compare(first2->first, first1->first); ++first1)
+         {
+            for (run_end2 = first2;
+                 run_end2 != last2 && !compare(first1->first, run_end2->first); ++run_end2)
+               function(first1->first, value1_t(first1->second), value2_t(run_end2->second));
+         }
+         first2 = run_end2;
+      }
+   }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace algorithm
+}   // end namespace utils
@@ -1,11 +1,19 @@
 #pragma once
 
-#include <exception>
+#include "../algo.hpp"
+#include "../threads/thread_pool.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 //--------------------------------------------------------------------------------------------------
 /// @file zip_map_values.hpp
-/// @brief Zips the values mapped to by the same keys in two unordered_maps
+/// @brief Zips the values mapped to by the same keys in two hash maps
 /// @author Susanne van den Elsen
 /// @date 2015-2017
 //--------------------------------------------------------------------------------------------------
@@ -13,10 +21,61 @@
 
 namespace utils {
 namespace algorithm {
+namespace detail {
+
+template <typename Value1, typename Value2, typename ZipFunction>
+using zip_result_t = typename std::decay<
+   typename std::result_of<const ZipFunction&(const Value1&, const Value2&)>::type>::type;
+
+template <typename Map1, typename Map2, typename ZipFunction>
+using zipped_map_t =
+   std::unordered_map<typename Map1::key_type,
+                      zip_result_t<typename Map1::mapped_type, typename Map2::mapped_type,
+                                   ZipFunction>,
+                      typename Map1::hasher, typename Map1::key_equal>;
+
+template <typename Map2, typename Key>
+const typename Map2::mapped_type& find_mapped(const Map2& map2, const Key& key)
+{
+   const auto mapping2 = map2.find(key);
+   if (mapping2 == map2.end())
+      throw std::invalid_argument("keys(map1) should be a subset of keys(map2)");
+   return mapping2->second;
+}
+
+}   // end namespace detail
+
+//--------------------------------------------------------------------------------------------------
 
 /// @brief Applies the given zip_function to pairs of values in map1 and map2 that share the
-/// same key. Stores the results in a new unordered_map under the shared key. Assumes that the
-/// keys of map2 are a subset of the keys of map1.
+/// same key. Stores the results in zipped under the shared key. Assumes that the keys of map1
+/// are a subset of the keys of map2, and throws std::invalid_argument otherwise.
+/// @details The maps can be std::unordered_maps or datastructures::flat_hash_maps. zipped is
+/// cleared first, but keeps its buckets, so that zipping into the same map repeatedly reuses its
+/// storage. It is reserved for map1.size() elements, so that it does not rehash while zipping.
+
+template <typename Map1, typename Map2, typename ZipFunction, typename ZippedMap>
+typename std::enable_if<!algo::execution::is_execution_policy<Map1>::value>::type zip_map_values(
+   const Map1& map1, const Map2& map2, const ZipFunction& zip_function, ZippedMap& zipped)
+{
+   zipped.clear();
+   zipped.reserve(map1.size());
+   for (const auto& mapping1 : map1)
+      zipped.emplace(mapping1.first,
+                     zip_function(mapping1.second, detail::find_mapped(map2, mapping1.first)));
+}
+
+/// @brief Returns a new unordered_map with the zipped values of map1 and map2 (see above).
+
+template <typename Map1, typename Map2, typename ZipFunction>
+detail::zipped_map_t<Map1, Map2, ZipFunction> zip_map_values(const Map1& map1,
+                                                             const Map2& map2,
+                                                             const ZipFunction& zip_function)
+{
+   detail::zipped_map_t<Map1, Map2, ZipFunction> zipped;
+   zip_map_values(map1, map2, zip_function, zipped);
+   return zipped;
+}
 
 template <typename KeyType, typename ValueType1, typename ValueType2, typename ZipType>
 std::unordered_map<KeyType, ZipType> zip_map_values(
@@ -24,17 +83,74 @@ std::unordered_map<KeyType, ZipType> zip_map_values(
    const std::unordered_map<KeyType, ValueType2>& map2,
    const std::function<ZipType(const ValueType1&, const ValueType2&)>& zip_function)
 {
-   using ZippedMap = std::unordered_map<KeyType, ZipType>;
-   ZippedMap zipped;
-   std::transform(map1.begin(), map1.end(), std::inserter(zipped, zipped.end()),
-                  [&map2, &zip_function](const auto& mapping1) {
-                     const auto mapping2 = map2.find(mapping1.first);
-                     if (mapping2 == map2.end())
-                        throw std::invalid_argument("keys(map2) should be a subset of keys(map1)");
-                     return typename ZippedMap::value_type(
-                        mapping1.first, zip_function(mapping1.second, mapping2->second));
-                  });
+   std::unordered_map<KeyType, ZipType> zipped;
+   zip_map_values(map1, map2, zip_function, zipped);
    return zipped;
 }
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief zip_map_values with an execution policy. With a parallel policy, chunks of the buckets
+/// of map1 are zipped in parallel, each into a shard of its own, and the shards are then moved
+/// into zipped. zip_function is therefore called concurrently, and must be safe to do so.
+
+template <typename ExecutionPolicy, typename Map1, typename Map2, typename ZipFunction,
+          typename ZippedMap>
+typename algo::detail::enable_if_execution_policy<ExecutionPolicy, void>::type zip_map_values(
+   ExecutionPolicy&& /* policy */,
+   const Map1& map1,
+   const Map2& map2,
+   const ZipFunction& zip_function,
+   ZippedMap& zipped)
+{
+   using Key = typename ZippedMap::key_type;
+   using Zip = typename ZippedMap::mapped_type;
+   const std::size_t chunks = algo::detail::chunk_count(map1.size());
+   if (std::is_same<typename std::decay<ExecutionPolicy>::type,
+                    algo::execution::sequenced_policy>::value ||
+       chunks == 1)
+   {
+      zip_map_values(map1, map2, zip_function, zipped);
+      return;
+   }
+   const std::size_t buckets = map1.bucket_count();
+   std::vector<std::vector<std::pair<const Key*, Zip>>> shards(chunks);
+   threads::default_pool().parallel_for(chunks, [&](const std::size_t chunk) {
+      auto& shard = shards[chunk];
+      shard.reserve(map1.size() / chunks);
+      const std::size_t end = algo::detail::chunk_begin(buckets, chunks, chunk + 1);
+      for (std::size_t bucket = algo::detail::chunk_begin(buckets, chunks, chunk); bucket < end;
+           ++bucket)
+      {
+         for (auto mapping1 = map1.begin(bucket); mapping1 != map1.end(bucket); ++mapping1)
+            shard.emplace_back(
+               &mapping1->first,
+               zip_function(mapping1->second, detail::find_mapped(map2, mapping1->first)));
+      }
+   });
+   zipped.clear();
+   zipped.reserve(map1.size());
+   for (auto& shard : shards)
+   {
+      for (auto& zip : shard)
+         zipped.emplace(*zip.first, std::move(zip.second));
+   }
+}
+
+template <typename ExecutionPolicy, typename Map1, typename Map2, typename ZipFunction>
+typename algo::detail::enable_if_execution_policy<
+   ExecutionPolicy, detail::zipped_map_t<Map1, Map2, ZipFunction>>::type
+zip_map_values(ExecutionPolicy&& policy,
+               const Map1& map1,
+               const Map2& map2,
+               const ZipFunction& zip_function)
+{
+   detail::zipped_map_t<Map1, Map2, ZipFunction> zipped;
+   zip_map_values(std::forward<ExecutionPolicy>(policy), map1, map2, zip_function, zipped);
+   return zipped;
 }
-}   // end namespace utils.algorithm
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace algorithm
+}   // end namespace utils
@@ -0,0 +1,291 @@
+
+#include "async_file_writer.hpp"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+
+namespace utils {
+namespace io {
+
+//--------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// @brief Reports ok through done, or through promise if there is no callback. Exceptions thrown
+/// by done are ignored, as they would otherwise terminate the background thread.
+
+void complete(std::promise<bool>& promise, const std::function<void(bool)>& done, const bool ok)
+{
+   if (!done)
+   {
+      promise.set_value(ok);
+      return;
+   }
+   try
+   {
+      done(ok);
+   }
+   catch (...)
+   {
+   }
+}
+
+/// @brief Writes all of iov[0,count) to fd, continuing after partial writes and interrupts.
+
+bool write_all(const int fd, struct iovec* iov, int count)
+{
+   while (count > 0)
+   {
+      const ssize_t written = ::writev(fd, iov, count);
+      if (written < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         return false;
+      }
+      std::size_t remaining = static_cast<std::size_t>(written);
+      while (count > 0 && remaining >= iov->iov_len)
+      {
+         remaining -= iov->iov_len;
+         ++iov;
+         --count;
+      }
+      if (count > 0)
+      {
+         iov->iov_base = static_cast<char*>(iov->iov_base) + remaining;
+         iov->iov_len -= remaining;
+      }
+   }
+   return true;
+}
+
+}   // end namespace
+
+//--------------------------------------------------------------------------------------------------
+
+constexpr std::uint32_t async_file_writer::no_slot;
+
+async_file_writer::async_file_writer()
+: m_stop(false)
+, m_thread(&async_file_writer::run, this)
+{
+}
+
+async_file_writer::~async_file_writer()
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+   }
+   m_queued.notify_one();
+   m_thread.join();
+   for (const file_slot& slot : m_files)
+   {
+      if (slot.m_open)
+         ::close(slot.m_fd);
+   }
+}
+
+boost::optional<async_file_writer::file_id> async_file_writer::open(const std::string& filename,
+                                                                    const open_mode mode)
+{
+   const int flags = O_WRONLY | O_CREAT | O_CLOEXEC |
+                     (mode == open_mode::append ? O_APPEND : O_TRUNC);
+   const int fd = ::open(filename.c_str(), flags, 0666);
+   if (fd == -1)
+      return boost::none;
+   std::lock_guard<std::mutex> lock(m_mutex);
+   if (m_free_slots.empty())
+   {
+      m_files.push_back({fd, 0, true});
+      return file_id{static_cast<std::uint32_t>(m_files.size() - 1), 0};
+   }
+   const std::uint32_t index = m_free_slots.back();
+   m_free_slots.pop_back();
+   file_slot& slot = m_files[index];
+   slot.m_fd = fd;
+   slot.m_open = true;
+   return file_id{index, slot.m_generation};
+}
+
+std::future<bool> async_file_writer::write(const file_id file, std::string data)
+{
+   return enqueue(request_kind::write, file, std::move(data));
+}
+
+void async_file_writer::write(const file_id file, std::string data, callback done)
+{
+   enqueue(file, request{request_kind::write, no_slot, -1, std::move(data), {}, std::move(done)});
+}
+
+std::future<bool> async_file_writer::flush(const file_id file)
+{
+   return enqueue(request_kind::flush, file, std::string());
+}
+
+std::future<bool> async_file_writer::sync(const file_id file)
+{
+   return enqueue(request_kind::sync, file, std::string());
+}
+
+std::future<bool> async_file_writer::close(const file_id file)
+{
+   return enqueue(request_kind::close, file, std::string());
+}
+
+std::future<bool> async_file_writer::enqueue(const request_kind kind,
+                                             const file_id file,
+                                             std::string data)
+{
+   request req{kind, no_slot, -1, std::move(data), {}, {}};
+   std::future<bool> result = req.m_promise.get_future();
+   enqueue(file, std::move(req));
+   return result;
+}
+
+void async_file_writer::enqueue(const file_id file, request&& req)
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (file.m_index < m_files.size())
+      {
+         file_slot& slot = m_files[file.m_index];
+         if (slot.m_open && slot.m_generation == file.m_generation)
+         {
+            req.m_slot = file.m_index;
+            req.m_fd = slot.m_fd;
+            if (req.m_kind == request_kind::close)
+               slot.m_open = false;
+         }
+      }
+      m_queue.push_back(std::move(req));
+   }
+   m_queued.notify_one();
+}
+
+/// @details Called by the background thread once the file of slot has been closed. Only then can
+/// the entry be reused, so that the requests queued before the close still find its descriptor.
+
+void async_file_writer::release(const std::uint32_t slot)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   ++m_files[slot].m_generation;
+   m_free_slots.push_back(slot);
+}
+
+void async_file_writer::run()
+{
+   std::vector<request> requests;
+   while (true)
+   {
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_queued.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+         if (m_queue.empty())
+            return;
+         requests.swap(m_queue);
+      }
+      process(requests);
+      requests.clear();
+   }
+}
+
+void async_file_writer::process(std::vector<request>& requests)
+{
+   // Group the requests by file, keeping their order per file. Requests for files that are not
+   // open fail right away.
+   std::vector<request*> order;
+   order.reserve(requests.size());
+   for (request& req : requests)
+   {
+      if (req.m_slot == no_slot)
+         complete(req.m_promise, req.m_done, false);
+      else
+         order.push_back(&req);
+   }
+   std::stable_sort(order.begin(), order.end(), [](const request* lhs, const request* rhs) {
+      return lhs->m_slot < rhs->m_slot;
+   });
+
+   std::vector<request*> file_requests;
+   for (auto it = order.begin(); it != order.end();)
+   {
+      const std::uint32_t slot = (*it)->m_slot;
+      const auto end = std::find_if(
+         it, order.end(), [slot](const request* req) { return req->m_slot != slot; });
+      file_requests.assign(it, end);
+      process_file(file_requests);
+      it = end;
+   }
+}
+
+void async_file_writer::process_file(const std::vector<request*>& requests)
+{
+   for (auto it = requests.begin(); it != requests.end();)
+   {
+      request& req = **it;
+      bool& failed = m_failed[req.m_slot];
+      switch (req.m_kind)
+      {
+         case request_kind::write:
+         {
+            const auto end = std::find_if(it, requests.end(), [](const request* other) {
+               return other->m_kind != request_kind::write;
+            });
+            write_run(&*it, &*it + (end - it));
+            it = end;
+            continue;
+         }
+         case request_kind::flush:
+            complete(req.m_promise, req.m_done, !failed);
+            failed = false;
+            break;
+         case request_kind::sync:
+            complete(req.m_promise, req.m_done, ::fsync(req.m_fd) == 0 && !failed);
+            failed = false;
+            break;
+         case request_kind::close:
+         {
+            const bool ok = !failed;
+            m_failed.erase(req.m_slot);
+            const bool closed = ::close(req.m_fd) == 0;
+            release(req.m_slot);
+            complete(req.m_promise, req.m_done, closed && ok);
+            break;
+         }
+      }
+      ++it;
+   }
+}
+
+/// @details Writes the data of consecutive write requests to the same file with as few writev
+/// calls as IOV_MAX permits.
+
+void async_file_writer::write_run(request* const* first, request* const* last)
+{
+   std::vector<struct iovec> iov;
+   while (first != last)
+   {
+      const std::size_t count = std::min<std::size_t>(last - first, IOV_MAX);
+      iov.clear();
+      for (std::size_t i = 0; i < count; ++i)
+         iov.push_back({const_cast<char*>(first[i]->m_data.data()), first[i]->m_data.size()});
+      const bool ok = write_all((*first)->m_fd, iov.data(), static_cast<int>(count));
+      if (!ok)
+         m_failed[(*first)->m_slot] = true;
+      for (std::size_t i = 0; i < count; ++i)
+         complete(first[i]->m_promise, first[i]->m_done, ok);
+      first += count;
+   }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace io
+}   // end namespace utils
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "format_to.hpp"
+
+#include <boost/optional.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//--------------------------------------------------------------------------------------------------
+/// @file async_file_writer.hpp
+/// @brief Asynchronous writing to files on a background thread, which coalesces queued writes to
+/// the same file into vectored writes.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace io {
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Writes data to files on a background thread.
+/// @details Requests for the same file are carried out in the order in which they are queued.
+/// All requests queued while the background thread is busy are taken at once, and consecutive
+/// writes to the same file among them are written with a single writev. Each request reports
+/// whether it succeeded, through a future or a callback that is called on the background
+/// thread. Callbacks must not queue requests and wait for their completion; exceptions they throw
+/// are ignored.
+///
+/// A file_id is an index into a table of files the writer owns, tagged with the generation of the
+/// table entry. Requests with a file_id that is closed (or queued for closing) fail without
+/// touching any file descriptor, even when the entry has been reused for a file opened later.
+///
+/// The destructor carries out all queued requests and closes the files that are still open.
+
+class async_file_writer
+{
+public:
+   struct file_id
+   {
+      std::uint32_t m_index;
+      std::uint32_t m_generation;
+   };
+
+   enum class open_mode
+   {
+      truncate,
+      append
+   };
+
+   using callback = std::function<void(bool)>;
+
+   async_file_writer();
+
+   async_file_writer(const async_file_writer&) = delete;
+   ~async_file_writer();
+
+   async_file_writer& operator=(const async_file_writer&) = delete;
+
+   /// @brief Opens (creating if needed) the given file for writing on the calling thread. Returns
+   /// boost::none if opening failed.
+   boost::optional<file_id> open(const std::string& filename, open_mode mode = open_mode::truncate);
+
+   /// @brief Queues writing data at the end of file.
+   std::future<bool> write(file_id file, std::string data);
+   void write(file_id file, std::string data, callback done);
+
+   /// @brief Queues writing the text operator<< produces for value followed by a newline, like
+   /// write_to_file does.
+   template <typename T>
+   std::future<bool> write_value(const file_id file, const T& value)
+   {
+      format_buffer buffer;
+      format_to(buffer, value);
+      buffer.push_back('\n');
+      return write(file, buffer.release());
+   }
+
+   /// @brief Queues a barrier that completes when all writes to file queued before it have been
+   /// handed to the operating system, with the conjunction of their results.
+   std::future<bool> flush(file_id file);
+
+   /// @brief Like flush, but additionally waits until the data of file is on the storage device
+   /// (fsync).
+   std::future<bool> sync(file_id file);
+
+   /// @brief Queues closing file after the requests queued before. The file_id becomes invalid.
+   std::future<bool> close(file_id file);
+
+private:
+   enum class request_kind
+   {
+      write,
+      flush,
+      sync,
+      close
+   };
+
+   /// @brief Entry of the file table.
+   struct file_slot
+   {
+      int m_fd;
+      std::uint32_t m_generation;
+      /// @brief Whether the file is open and not queued for closing.
+      bool m_open;
+   };
+
+   /// @brief m_slot of requests whose file_id is not open.
+   static constexpr std::uint32_t no_slot = static_cast<std::uint32_t>(-1);
+
+   struct request
+   {
+      request_kind m_kind;
+      std::uint32_t m_slot;
+      /// @brief Descriptor of the file, or -1 if m_slot is no_slot.
+      int m_fd;
+      std::string m_data;
+      std::promise<bool> m_promise;
+      callback m_done;
+   };
+
+   std::mutex m_mutex;
+
+   std::condition_variable m_queued;
+
+   std::vector<request> m_queue;
+
+   bool m_stop;
+
+   std::vector<file_slot> m_files;
+
+   /// @brief Indices of the entries of m_files whose file has been closed, for reuse.
+   std::vector<std::uint32_t> m_free_slots;
+
+   /// @brief Per file table entry, whether a write failed since the last barrier. Only accessed
+   /// by the background thread.
+   std::unordered_map<std::uint32_t, bool> m_failed;
+
+   std::thread m_thread;
+
+   std::future<bool> enqueue(request_kind kind, file_id file, std::string data);
+
+   /// @brief Resolves file to its table entry and descriptor and queues req. Closing marks the
+   /// entry as no longer open.
+   void enqueue(file_id file, request&& req);
+
+   void release(std::uint32_t slot);
+
+   void run();
+   void process(std::vector<request>& requests);
+   void process_file(const std::vector<request*>& requests);
+   void write_run(request* const* first, request* const* last);
+
+};   // end class async_file_writer
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace io
+}   // end namespace utils
@@ -0,0 +1,468 @@
+#pragma once
+
+#include "container_format.hpp"   // includes STL containers
+#include "container_inserter.hpp"
+#include "fixed_size_vector.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+//--------------------------------------------------------------------------------------------------
+/// @file binary_io.hpp
+/// @brief Compact binary serialization of arithmetic values, strings, std::pair, the supported
+/// containers and datastructures::fixed_size_vector, as a counterpart of the text format.
+/// @details Layout:
+/// - header: the magic "UTLB", a version byte, a byte-order byte (1: little, 2: big endian) and
+///   the sizes of a length field and of a long double in bytes;
+/// - bitwise serializable values (see is_bitwise_serializable): their object representation;
+/// - std::string and containers: their number of elements as a std::uint64_t, followed by the
+///   elements. Contiguous containers of bitwise serializable values are written as one block;
+/// - std::pair: its first and second element.
+/// Values are written in the byte order of the writing machine. Files written on a machine with a
+/// different byte order are rejected when reading.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace io {
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Whether values of type T are serialized as their object representation. True for
+/// arithmetic types and enumerations. May be specialized for trivially copyable user types
+/// without padding or pointers.
+
+template <typename T>
+struct is_bitwise_serializable
+   : public std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value>
+{
+};
+
+//--------------------------------------------------------------------------------------------------
+
+namespace binary {
+
+constexpr char magic[4] = {'U', 'T', 'L', 'B'};
+
+constexpr std::uint8_t version = 1;
+
+enum class byte_order : std::uint8_t
+{
+   little = 1,
+   big = 2
+};
+
+inline byte_order native_byte_order()
+{
+   const std::uint16_t probe = 1;
+   std::uint8_t first;
+   std::memcpy(&first, &probe, 1);
+   return first == 1 ? byte_order::little : byte_order::big;
+}
+
+using size_type = std::uint64_t;
+
+/// @brief The maximal number of elements reserved up front when reading a container, limiting the
+/// damage done by a corrupt length field.
+constexpr size_type max_reserve = size_type(1) << 24;
+
+template <typename Container>
+struct is_contiguous : public std::false_type
+{
+};
+
+template <typename T, typename Allocator>
+struct is_contiguous<std::vector<T, Allocator>> : public std::true_type
+{
+};
+
+template <typename T, std::size_t N>
+struct is_contiguous<std::array<T, N>> : public std::true_type
+{
+};
+
+/// @brief Whether contiguous sequences of T are copied as one block.
+template <typename T>
+struct is_bulk_element
+   : public std::integral_constant<bool, is_bitwise_serializable<T>::value &&
+                                            !std::is_same<T, bool>::value>
+{
+};
+
+}   // end namespace binary
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Writes values in the binary format to a streambuf.
+/// @details Writing stops at the first failing write, after which good() returns false.
+
+class binary_writer
+{
+public:
+   explicit binary_writer(std::streambuf& buffer)
+   : m_buffer(buffer)
+   , m_good(true)
+   {
+   }
+
+   bool good() const
+   {
+      return m_good;
+   }
+
+   void write_header()
+   {
+      write_bytes(binary::magic, sizeof(binary::magic));
+      const std::uint8_t fields[] = {binary::version,
+                                     static_cast<std::uint8_t>(binary::native_byte_order()),
+                                     sizeof(binary::size_type), sizeof(long double)};
+      write_bytes(fields, sizeof(fields));
+   }
+
+   void write_bytes(const void* data, const std::size_t size)
+   {
+      if (m_good && size != 0)
+         m_good = m_buffer.sputn(static_cast<const char*>(data),
+                                 static_cast<std::streamsize>(size)) ==
+                  static_cast<std::streamsize>(size);
+   }
+
+   void write_size(const std::size_t size)
+   {
+      const binary::size_type value = size;
+      write_bytes(&value, sizeof(value));
+   }
+
+   template <typename T>
+   typename std::enable_if<is_bitwise_serializable<T>::value>::type write(const T& value)
+   {
+      write_bytes(&value, sizeof(T));
+   }
+
+   void write(const std::string& string)
+   {
+      write_size(string.size());
+      write_bytes(string.data(), string.size());
+   }
+
+   template <typename T1, typename T2>
+   void write(const std::pair<T1, T2>& pair)
+   {
+      write(pair.first);
+      write(pair.second);
+   }
+
+   template <typename Container>
+   typename std::enable_if<supported_container<Container>::value>::type
+   write(const Container& container)
+   {
+      using T = typename Container::value_type;
+      using bulk = std::integral_constant<bool, binary::is_contiguous<Container>::value &&
+                                                   binary::is_bulk_element<T>::value>;
+      write_size(static_cast<std::size_t>(std::distance(container.begin(), container.end())));
+      write_elements(container, bulk{});
+   }
+
+   template <typename T, std::size_t N, typename Allocator>
+   void write(const datastructures::fixed_size_vector<T, N, Allocator>& vector)
+   {
+      write_size(vector.size());
+      write_elements(vector, binary::is_bulk_element<T>{});
+   }
+
+private:
+   std::streambuf& m_buffer;
+
+   bool m_good;
+
+   template <typename Container>
+   void write_elements(const Container& container, std::true_type /* bulk */)
+   {
+      using T = typename std::remove_cv<
+         typename std::remove_reference<decltype(*container.data())>::type>::type;
+      write_bytes(container.data(), container.size() * sizeof(T));
+   }
+
+   template <typename Container>
+   void write_elements(const Container& container, std::false_type /* bulk */)
+   {
+      for (auto it = container.cbegin(); it != container.cend() && m_good; ++it)
+         write(*it);
+   }
+
+};   // end class binary_writer
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Reads values in the binary format from a streambuf.
+/// @details Elements read into a container are appended to it, like with operator>>. Reading
+/// stops at the first failure, after which good() returns false and state() reports failbit,
+/// and eofbit if the input ended prematurely.
+
+class binary_reader
+{
+public:
+   explicit binary_reader(std::streambuf& buffer)
+   : m_buffer(buffer)
+   , m_state(std::ios_base::goodbit)
+   {
+   }
+
+   bool good() const
+   {
+      return m_state == std::ios_base::goodbit;
+   }
+
+   std::ios_base::iostate state() const
+   {
+      return m_state;
+   }
+
+   /// @brief Reads and checks the header. Fails if it was written by a different version of the
+   /// format or on a machine with a different data representation.
+
+   bool read_header()
+   {
+      char magic[sizeof(binary::magic)];
+      std::uint8_t fields[4];
+      if (!read_bytes(magic, sizeof(magic)) || !read_bytes(fields, sizeof(fields)))
+         return false;
+      if (std::memcmp(magic, binary::magic, sizeof(magic)) != 0 || fields[0] != binary::version ||
+          fields[1] != static_cast<std::uint8_t>(binary::native_byte_order()) ||
+          fields[2] != sizeof(binary::size_type) || fields[3] != sizeof(long double))
+         return fail();
+      return true;
+   }
+
+   bool read_bytes(void* data, const std::size_t size)
+   {
+      if (!good())
+         return false;
+      const std::streamsize count = static_cast<std::streamsize>(size);
+      if (count != 0 && m_buffer.sgetn(static_cast<char*>(data), count) != count)
+      {
+         m_state |= std::ios_base::eofbit;
+         return fail();
+      }
+      return true;
+   }
+
+   bool read_size(std::size_t& size)
+   {
+      binary::size_type value;
+      if (!read_bytes(&value, sizeof(value)))
+         return false;
+      size = static_cast<std::size_t>(value);
+      return true;
+   }
+
+   template <typename T>
+   typename std::enable_if<is_bitwise_serializable<T>::value, bool>::type read(T& value)
+   {
+      return read_bytes(&value, sizeof(T));
+   }
+
+   bool read(std::string& string)
+   {
+      std::size_t size;
+      if (!read_size(size))
+         return false;
+      string.clear();
+      return read_block(string, size);
+   }
+
+   template <typename T1, typename T2>
+   bool read(std::pair<T1, T2>& pair)
+   {
+      return read(pair.first) && read(pair.second);
+   }
+
+   template <typename Container>
+   typename std::enable_if<supported_container<Container>::value, bool>::type
+   read(Container& container)
+   {
+      using T = typename read_value<Container>::type;
+      using bulk = std::integral_constant<bool, binary::is_contiguous<Container>::value &&
+                                                   binary::is_bulk_element<T>::value>;
+      std::size_t size;
+      return read_size(size) && read_elements(container, size, bulk{});
+   }
+
+   template <typename T, std::size_t N, typename Allocator>
+   bool read(datastructures::fixed_size_vector<T, N, Allocator>& vector)
+   {
+      std::size_t size;
+      return read_size(size) && read_elements(vector, size, binary::is_bulk_element<T>{});
+   }
+
+private:
+   std::streambuf& m_buffer;
+
+   std::ios_base::iostate m_state;
+
+   bool fail()
+   {
+      m_state |= std::ios_base::failbit;
+      return false;
+   }
+
+   /// @brief Appends size bitwise serializable elements to a resizable contiguous container,
+   /// growing it in bounded steps so that a corrupt size cannot exhaust memory before the input
+   /// runs out.
+
+   template <typename Container>
+   bool read_block(Container& container, std::size_t size)
+   {
+      using T = typename Container::value_type;
+      while (size != 0)
+      {
+         const std::size_t step = std::min<std::size_t>(size, binary::max_reserve);
+         const std::size_t offset = container.size();
+         container.resize(offset + step);
+         if (!read_bytes(&container[offset], step * sizeof(T)))
+            return false;
+         size -= step;
+      }
+      return true;
+   }
+
+   template <typename T, typename Allocator>
+   bool read_elements(std::vector<T, Allocator>& vector, const std::size_t size,
+                      std::true_type /* bulk */)
+   {
+      return read_block(vector, size);
+   }
+
+   template <typename T, std::size_t N>
+   bool read_elements(std::array<T, N>& array, const std::size_t size, std::true_type /* bulk */)
+   {
+      return size == N ? read_bytes(array.data(), sizeof(array)) : fail();
+   }
+
+   template <typename T, std::size_t N, typename Allocator>
+   bool read_elements(datastructures::fixed_size_vector<T, N, Allocator>& vector,
+                      const std::size_t size,
+                      std::true_type /* bulk */)
+   {
+      // Read into a growing buffer first, as a corrupt size must not allocate up front
+      std::vector<T> elements;
+      if (!read_block(elements, size))
+         return false;
+      datastructures::fixed_size_vector<T, N, Allocator> result(size, T(), vector.get_allocator());
+      std::copy(elements.begin(), elements.end(), result.begin());
+      vector = std::move(result);
+      return true;
+   }
+
+   template <typename T, std::size_t N, typename Allocator>
+   bool read_elements(datastructures::fixed_size_vector<T, N, Allocator>& vector,
+                      const std::size_t size,
+                      std::false_type /* bulk */)
+   {
+      std::vector<T> elements;
+      elements.reserve(std::min<std::size_t>(size, binary::max_reserve));
+      for (std::size_t i = 0; i < size; ++i)
+      {
+         T value{};
+         if (!read(value))
+            return false;
+         elements.push_back(std::move(value));
+      }
+      datastructures::fixed_size_vector<T, N, Allocator> result(size, T(), vector.get_allocator());
+      std::move(elements.begin(), elements.end(), result.begin());
+      vector = std::move(result);
+      return true;
+   }
+
+   template <typename Container>
+   bool read_elements(Container& container, const std::size_t size, std::false_type /* bulk */)
+   {
+      using T = typename read_value<Container>::type;
+      container_inserter<Container> inserter(container);
+      inserter.reserve(std::min<std::size_t>(size, binary::max_reserve));
+      for (std::size_t i = 0; i < size; ++i)
+      {
+         T value{};
+         if (!read(value))
+            return false;
+         inserter.insert(std::move(value));
+      }
+      return inserter.finish() || fail();
+   }
+
+};   // end class binary_reader
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Writes the binary header followed by t to os. Sets badbit on os if writing fails.
+
+template <typename T>
+std::ostream& write_binary(std::ostream& os, const T& t)
+{
+   const std::ostream::sentry ok(os);
+   if (ok)
+   {
+      binary_writer writer(*os.rdbuf());
+      writer.write_header();
+      writer.write(t);
+      if (!writer.good())
+         os.setstate(std::ios_base::badbit);
+   }
+   return os;
+}
+
+/// @brief Reads the binary header followed by t from is. Sets failbit on is if the header does not
+/// match or the input does not contain a complete t.
+
+template <typename T>
+std::istream& read_binary(std::istream& is, T& t)
+{
+   const std::istream::sentry ok(is, true);
+   if (ok)
+   {
+      binary_reader reader(*is.rdbuf());
+      if (reader.read_header())
+         reader.read(t);
+      is.setstate(reader.state());
+   }
+   return is;
+}
+
+template <typename T>
+bool write_binary_to_file(const std::string& filename, const T& t)
+{
+   std::ofstream ofs(filename, std::ios_base::out | std::ios_base::binary);
+   write_binary(ofs, t);
+   ofs.close();
+   return !ofs.fail();
+}
+
+/// @brief Reads t from the given file in the binary format, copying bulk data directly from a
+/// mapping of the file.
+
+template <typename T>
+bool read_binary_from_file(const std::string& filename, T& t)
+{
+   const mapped_file file(filename);
+   if (!file.is_open())
+      return false;
+   memory_streambuf buffer(file.view());
+   std::istream is(&buffer);
+   return !read_binary(is, t).fail();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace io
+}   // end namespace utils
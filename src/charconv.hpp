@@ -0,0 +1,316 @@
+#pragma once
+
+#include <locale.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+//--------------------------------------------------------------------------------------------------
+/// @file charconv.hpp
+/// @brief Locale-independent conversions between character sequences and arithmetic values,
+/// modelled after C++17's <charconv>.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace io {
+
+enum class chars_format
+{
+   scientific = 1,
+   fixed = 2,
+   hex = 4,
+   general = fixed | scientific
+};
+
+struct from_chars_result
+{
+   const char* ptr;
+   std::errc ec;
+};
+
+struct to_chars_result
+{
+   char* ptr;
+   std::errc ec;
+};
+
+namespace detail {
+
+inline int digit_value(const char c)
+{
+   if (c >= '0' && c <= '9')
+      return c - '0';
+   if (c >= 'a' && c <= 'z')
+      return c - 'a' + 10;
+   if (c >= 'A' && c <= 'Z')
+      return c - 'A' + 10;
+   return 36;
+}
+
+/// @brief Returns the "C" locale used for floating-point conversions, so that the result does not
+/// depend on the LC_NUMERIC setting of the process.
+
+inline locale_t c_locale()
+{
+   static const locale_t locale = newlocale(LC_ALL_MASK, "C", static_cast<locale_t>(0));
+   return locale;
+}
+
+inline void strtof_l(const char* str, char** end, float& value)
+{
+   value = ::strtof_l(str, end, c_locale());
+}
+
+inline void strtof_l(const char* str, char** end, double& value)
+{
+   value = ::strtod_l(str, end, c_locale());
+}
+
+inline void strtof_l(const char* str, char** end, long double& value)
+{
+   value = ::strtold_l(str, end, c_locale());
+}
+
+/// @brief Returns the printf conversion for fmt with the length modifier of T.
+
+template <typename T>
+const char* printf_format(const chars_format fmt)
+{
+   const bool is_long = std::is_same<T, long double>::value;
+   switch (fmt)
+   {
+      case chars_format::scientific:
+         return is_long ? "%.*Le" : "%.*e";
+      case chars_format::fixed:
+         return is_long ? "%.*Lf" : "%.*f";
+      case chars_format::hex:
+         return is_long ? "%.*La" : "%.*a";
+      case chars_format::general:
+         break;
+   }
+   return is_long ? "%.*Lg" : "%.*g";
+}
+
+/// @brief Switches the calling thread to the "C" locale for its lifetime.
+
+class scoped_c_locale
+{
+public:
+   scoped_c_locale()
+   : m_previous(uselocale(c_locale()))
+   {
+   }
+
+   scoped_c_locale(const scoped_c_locale&) = delete;
+
+   ~scoped_c_locale()
+   {
+      uselocale(m_previous);
+   }
+
+   scoped_c_locale& operator=(const scoped_c_locale&) = delete;
+
+private:
+   locale_t m_previous;
+};
+
+/// @brief Returns the end of the longest prefix of [first,last) matching the decimal
+/// floating-point pattern [-]digits[.digits][(e|E)[+|-]digits], or first if there is none.
+
+inline const char* scan_float(const char* first, const char* last)
+{
+   const char* pos = first;
+   if (pos != last && *pos == '-')
+      ++pos;
+   bool found_mantissa = false;
+   while (pos != last && *pos >= '0' && *pos <= '9')
+   {
+      ++pos;
+      found_mantissa = true;
+   }
+   if (pos != last && *pos == '.')
+   {
+      ++pos;
+      while (pos != last && *pos >= '0' && *pos <= '9')
+      {
+         ++pos;
+         found_mantissa = true;
+      }
+   }
+   if (!found_mantissa)
+      return first;
+   if (pos != last && (*pos == 'e' || *pos == 'E'))
+   {
+      const char* exponent = pos + 1;
+      if (exponent != last && (*exponent == '+' || *exponent == '-'))
+         ++exponent;
+      if (exponent != last && *exponent >= '0' && *exponent <= '9')
+      {
+         pos = exponent;
+         while (pos != last && *pos >= '0' && *pos <= '9')
+            ++pos;
+      }
+   }
+   return pos;
+}
+
+}   // end namespace detail
+
+/// @brief Parses an integer value from [first,last) in the given base, without skipping
+/// whitespace and without accepting a leading '+'. A leading '-' is only accepted for signed T.
+/// @details On success, ec is value-initialized and ptr points at the first character not
+/// matching the pattern. If no character matches, ec is invalid_argument and ptr is first. If
+/// the matched value does not fit in T, ec is result_out_of_range. In both error cases value is
+/// left unmodified.
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                        from_chars_result>::type
+from_chars(const char* first, const char* last, T& value, const int base = 10)
+{
+   using unsigned_t = typename std::make_unsigned<T>::type;
+
+   const char* pos = first;
+   bool negative = false;
+   if (std::is_signed<T>::value && pos != last && *pos == '-')
+   {
+      negative = true;
+      ++pos;
+   }
+
+   const unsigned_t max = negative ? unsigned_t(unsigned_t(std::numeric_limits<T>::max()) + 1)
+                                   : unsigned_t(std::numeric_limits<T>::max());
+   unsigned_t result = 0;
+   bool overflow = false;
+   const char* const digits_begin = pos;
+   for (; pos != last; ++pos)
+   {
+      const int digit = detail::digit_value(*pos);
+      if (digit >= base)
+         break;
+      if (result > (max - unsigned_t(digit)) / unsigned_t(base))
+         overflow = true;
+      else
+         result = unsigned_t(result * unsigned_t(base) + unsigned_t(digit));
+   }
+
+   if (pos == digits_begin)
+      return {first, std::errc::invalid_argument};
+   if (overflow)
+      return {pos, std::errc::result_out_of_range};
+   value = negative ? T(unsigned_t(0) - result) : T(result);
+   return {pos, std::errc()};
+}
+
+/// @brief Parses a floating-point value from [first,last) in the fixed or scientific decimal
+/// format, without skipping whitespace and without accepting a leading '+'.
+/// @details Error reporting follows the integral overload. Values that overflow T are reported
+/// as result_out_of_range, values that underflow are rounded.
+/// @note Hexadecimal floating-point, infinity and NaN are not recognized.
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, from_chars_result>::type
+from_chars(const char* first, const char* last, T& value)
+{
+   const char* const end = detail::scan_float(first, last);
+   if (end == first)
+      return {first, std::errc::invalid_argument};
+
+   // strtod requires a null-terminated string
+   const std::size_t length = static_cast<std::size_t>(end - first);
+   char small[64];
+   std::string large;
+   const char* str = small;
+   if (length < sizeof(small))
+   {
+      std::char_traits<char>::copy(small, first, length);
+      small[length] = '\0';
+   }
+   else
+   {
+      large.assign(first, end);
+      str = large.c_str();
+   }
+
+   const int saved_errno = errno;
+   errno = 0;
+   T result;
+   detail::strtof_l(str, nullptr, result);
+   const bool out_of_range = errno == ERANGE && (result == std::numeric_limits<T>::infinity() ||
+                                                 result == -std::numeric_limits<T>::infinity());
+   errno = saved_errno;
+
+   if (out_of_range)
+      return {end, std::errc::result_out_of_range};
+   value = result;
+   return {end, std::errc()};
+}
+
+/// @brief Writes the decimal representation of an integer value to [first,last).
+/// @details On success, ec is value-initialized and ptr is one past the last character written.
+/// If the representation does not fit, ec is value_too_large, ptr is last and the contents of
+/// [first,last) are unspecified.
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                        to_chars_result>::type
+to_chars(char* first, char* last, const T value)
+{
+   using unsigned_t = typename std::make_unsigned<T>::type;
+
+   unsigned_t magnitude = static_cast<unsigned_t>(value);
+   if (value < 0)
+   {
+      if (first == last)
+         return {last, std::errc::value_too_large};
+      *first++ = '-';
+      magnitude = unsigned_t(unsigned_t(0) - magnitude);
+   }
+
+   char digits[std::numeric_limits<unsigned_t>::digits10 + 1];
+   char* pos = digits + sizeof(digits);
+   do
+   {
+      *--pos = static_cast<char>('0' + magnitude % 10);
+      magnitude = unsigned_t(magnitude / 10);
+   } while (magnitude != 0);
+
+   const std::size_t length = static_cast<std::size_t>(digits + sizeof(digits) - pos);
+   if (static_cast<std::size_t>(last - first) < length)
+      return {last, std::errc::value_too_large};
+   std::char_traits<char>::copy(first, pos, length);
+   return {first + length, std::errc()};
+}
+
+/// @brief Writes the representation of a floating-point value with the given format and precision
+/// to [first,last), as printf does with the corresponding conversion in the "C" locale.
+/// @details With chars_format::general and precision 6, the result equals the output of
+/// operator<< on a stream with default formatting flags. Error reporting follows the integral
+/// overload.
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, to_chars_result>::type
+to_chars(char* first, char* last, const T value, const chars_format fmt, const int precision)
+{
+   using print_t = typename std::conditional<std::is_same<T, long double>::value, long double,
+                                             double>::type;
+   const detail::scoped_c_locale locale;
+   const std::size_t size = static_cast<std::size_t>(last - first);
+   const int length = std::snprintf(first, size, detail::printf_format<T>(fmt), precision,
+                                    static_cast<print_t>(value));
+   // snprintf writes a terminating null character, which is not part of the result
+   if (length < 0 || static_cast<std::size_t>(length) >= size)
+      return {last, std::errc::value_too_large};
+   return {first + length, std::errc()};
+}
+
+}   // end namespace io
+}   // end namespace utils
@@ -6,10 +6,13 @@
 #include <type_traits>
 // Containers
 #include <array>
+#include <deque>
 #include <forward_list>
 #include <list>
+#include <map>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 /*---------------------------------------------------------------------------75*/
@@ -39,12 +42,66 @@ namespace utils
             char mDel;
         }; // end struct ContainerFormat
         
+        /**
+         @brief Compile-time container format. It can be used wherever a
+         container_format_values is expected, and code that is templated on
+         the format type compares against its characters as constants.
+         @details Example: format<'[', ']', ';'>.
+         */
+        template<char Left, char Right, char Del>
+        struct format
+        {
+            static constexpr char mLeft = Left;
+            static constexpr char mRight = Right;
+            static constexpr char mDel = Del;
+            
+            constexpr operator container_format_values() const
+            {
+                return { Left, Right, Del };
+            }
+        }; // end struct template format
+        
+        template<char Left, char Right, char Del>
+        constexpr char format<Left, Right, Del>::mLeft;
+        
+        template<char Left, char Right, char Del>
+        constexpr char format<Left, Right, Del>::mRight;
+        
+        template<char Left, char Right, char Del>
+        constexpr char format<Left, Right, Del>::mDel;
+        
+        /**
+         @brief Associates a Container with its default format. Specializations
+         provide it as mFormat, an instance of the format<...> type named
+         type.
+         */
         template<typename Container>
         struct container_format
         {
             static container_format_values mFormat;
         };
         
+        /**
+         @brief Reference to a container that is read or written in Format
+         instead of its default format. Elements that are containers
+         themselves keep their default formats.
+         */
+        template<typename Format, typename Container>
+        struct formatted
+        {
+            Container& mContainer;
+        };
+        
+        /**
+         @brief Returns a reference to C for reading or writing it in Format,
+         e.g. os << with_format<format<'[', ']', ';'>>(C).
+         */
+        template<typename Format, typename Container>
+        formatted<Format, Container> with_format(Container& C)
+        {
+            return { C };
+        }
+        
         // SUPPORTED CONTAINERS
         
         /**
@@ -63,8 +120,8 @@ namespace utils
         template<typename T, size_t n>
         struct container_format<std::array<T, n>>
         {
-            const container_format_values mFormat;
-            container_format() : mFormat({ '[', ']', ',' }) { }
+            using type = format<'[', ']', ','>;
+            const type mFormat{};
         };
 		
 		// std::forward_list
@@ -78,8 +135,8 @@ namespace utils
 		template<typename T, typename Allocator>
 		struct container_format<std::forward_list<T, Allocator>>
 		{
-			const container_format_values mFormat;
-			container_format() : mFormat({ '[', ']', ',' }) { }
+			using type = format<'[', ']', ','>;
+			const type mFormat{};
 		};
         
         // std::list
@@ -93,8 +150,8 @@ namespace utils
         template<typename T, typename Allocator>
         struct container_format<std::list<T, Allocator>>
         {
-            const container_format_values mFormat;
-            container_format() : mFormat({ '[', ']', ',' }) { }
+            using type = format<'[', ']', ','>;
+            const type mFormat{};
         };
 		
         // std::pair
@@ -105,8 +162,8 @@ namespace utils
         template<typename T1, typename T2>
         struct container_format<std::pair<T1,T2>>
         {
-            const container_format_values mFormat;
-            container_format() : mFormat({ '(', ')', ',' }) { }
+            using type = format<'(', ')', ','>;
+            const type mFormat{};
         };
         
         // std::set
@@ -120,38 +177,183 @@ namespace utils
         template<typename T, typename Traits, typename Allocator>
         struct container_format<std::set<T, Traits, Allocator>>
         {
-            const container_format_values mFormat;
-            container_format() : mFormat({ '{', '}', ',' }) { }
+            using type = format<'{', '}', ','>;
+            const type mFormat{};
+        };
+        
+        // std::multiset
+        
+        template<typename T, typename Traits, typename Allocator>
+        struct supported_container<std::multiset<T, Traits, Allocator>> : public std::true_type {};
+        
+        /**
+         @brief Default format for std::multiset is {el1,...,eln}.
+         */
+        template<typename T, typename Traits, typename Allocator>
+        struct container_format<std::multiset<T, Traits, Allocator>>
+        {
+            using type = format<'{', '}', ','>;
+            const type mFormat{};
+        };
+        
+        // std::map
+        
+        template<typename TKey, typename TVal, typename Traits, typename Allocator>
+        struct supported_container<std::map<TKey, TVal, Traits, Allocator>>
+        : public std::true_type {};
+        
+        /**
+         @brief Default format for std::map is {(key1,val1),...,(keyn,valn)}.
+         */
+        template<typename TKey, typename TVal, typename Traits, typename Allocator>
+        struct container_format<std::map<TKey, TVal, Traits, Allocator>>
+        {
+            using type = format<'{', '}', ','>;
+            const type mFormat{};
+        };
+        
+        // std::multimap
+        
+        template<typename TKey, typename TVal, typename Traits, typename Allocator>
+        struct supported_container<std::multimap<TKey, TVal, Traits, Allocator>>
+        : public std::true_type {};
+        
+        /**
+         @brief Default format for std::multimap is {(key1,val1),...,(keyn,valn)}.
+         */
+        template<typename TKey, typename TVal, typename Traits, typename Allocator>
+        struct container_format<std::multimap<TKey, TVal, Traits, Allocator>>
+        {
+            using type = format<'{', '}', ','>;
+            const type mFormat{};
         };
         
         // std::unordered_map
         
-        template<typename TKey, typename TVal>
-        struct supported_container<std::unordered_map<TKey,TVal>> : public std::true_type {};
+        template<typename TKey, typename TVal, typename Hash, typename KeyEqual, typename Allocator>
+        struct supported_container<std::unordered_map<TKey, TVal, Hash, KeyEqual, Allocator>>
+        : public std::true_type {};
         
         /**
-         @brief Default format for std::unordered_map.
+         @brief Default format for std::unordered_map is {(key1,val1),...,(keyn,valn)}.
          */
-        template<typename TKey, typename TVal>
-        struct container_format<std::unordered_map<TKey,TVal>>
+        template<typename TKey, typename TVal, typename Hash, typename KeyEqual, typename Allocator>
+        struct container_format<std::unordered_map<TKey, TVal, Hash, KeyEqual, Allocator>>
+        {
+            using type = format<'{', '}', ','>;
+            const type mFormat{};
+        };
+        
+        // std::unordered_multimap
+        
+        template<typename TKey, typename TVal, typename Hash, typename KeyEqual, typename Allocator>
+        struct supported_container<std::unordered_multimap<TKey, TVal, Hash, KeyEqual, Allocator>>
+        : public std::true_type {};
+        
+        /**
+         @brief Default format for std::unordered_multimap is {(key1,val1),...,(keyn,valn)}.
+         */
+        template<typename TKey, typename TVal, typename Hash, typename KeyEqual, typename Allocator>
+        struct container_format<std::unordered_multimap<TKey, TVal, Hash, KeyEqual, Allocator>>
+        {
+            using type = format<'{', '}', ','>;
+            const type mFormat{};
+        };
+        
+        // std::unordered_set
+        
+        template<typename T, typename Hash, typename KeyEqual, typename Allocator>
+        struct supported_container<std::unordered_set<T, Hash, KeyEqual, Allocator>>
+        : public std::true_type {};
+        
+        /**
+         @brief Default format for std::unordered_set is {el1,...,eln}.
+         */
+        template<typename T, typename Hash, typename KeyEqual, typename Allocator>
+        struct container_format<std::unordered_set<T, Hash, KeyEqual, Allocator>>
+        {
+            using type = format<'{', '}', ','>;
+            const type mFormat{};
+        };
+        
+        // std::unordered_multiset
+        
+        template<typename T, typename Hash, typename KeyEqual, typename Allocator>
+        struct supported_container<std::unordered_multiset<T, Hash, KeyEqual, Allocator>>
+        : public std::true_type {};
+        
+        /**
+         @brief Default format for std::unordered_multiset is {el1,...,eln}.
+         */
+        template<typename T, typename Hash, typename KeyEqual, typename Allocator>
+        struct container_format<std::unordered_multiset<T, Hash, KeyEqual, Allocator>>
         {
-            const container_format_values mFormat;
-            container_format() : mFormat({ '{', '}', ',' }) { }
+            using type = format<'{', '}', ','>;
+            const type mFormat{};
+        };
+        
+        // std::deque
+        
+        template<typename T, typename Allocator>
+        struct supported_container<std::deque<T, Allocator>> : public std::true_type {};
+        
+        /**
+         @brief Default format for std::deque is [el1,...,eln].
+         */
+        template<typename T, typename Allocator>
+        struct container_format<std::deque<T, Allocator>>
+        {
+            using type = format<'[', ']', ','>;
+            const type mFormat{};
         };
         
         // std::vector
         
-        template<typename T>
-        struct supported_container<std::vector<T>> : public std::true_type {};
+        template<typename T, typename Allocator>
+        struct supported_container<std::vector<T, Allocator>> : public std::true_type {};
         
         /**
          @brief Default format for std::vector is <el1,...,eln>.
          */
+        template<typename T, typename Allocator>
+        struct container_format<std::vector<T, Allocator>>
+        {
+            using type = format<'<', '>', ','>;
+            const type mFormat{};
+        };
+        
+        // READ_VALUE
+        
         template<typename T>
-        struct container_format<std::vector<T>>
+        struct unconst
+        {
+            using type = T;
+        };
+        
+        template<typename T>
+        struct unconst<const T>
+        {
+            using type = T;
+        };
+        
+        template<typename TKey, typename TVal>
+        struct unconst<std::pair<const TKey, TVal>>
+        {
+            using type = std::pair<TKey, TVal>;
+        };
+        
+        /**
+         @details The read_value::type for a Container is its value_type
+         without const. For maps, whose value_type is std::pair<const TKey,
+         TVal>, it is std::pair<TKey,TVal>, because the template function
+         overloading operator>> for std::pair<T1,_> assigns the read value
+         to the pair argument's first element, which is not allowed if that
+         element is of type const _.
+         */
+        template<typename Container>
+        struct read_value
         {
-            const container_format_values mFormat;
-            container_format() : mFormat({ '<', '>', ',' }) { }
+            using type = typename unconst<typename Container::value_type>::type;
         };
     } // end namespace utils.io
 } // end namespace utils
@@ -2,9 +2,14 @@
 #ifndef CONTAINER_INPUT_HPP_INCLUDED
 #define CONTAINER_INPUT_HPP_INCLUDED
 
+#include <algorithm>
+#include <istream>
 #include <iterator>
-#include "debug.hpp"
+#include <memory>
+#include "logging.hpp"
 #include "container_format.hpp" // includes STL containers
+#include "container_inserter.hpp"
+#include "container_scanner.hpp"
 
 /*---------------------------------------------------------------------------75*/
 /**
@@ -37,6 +42,41 @@ namespace utils
             mask mTable[table_size];
             
         }; // end class container_ctype
+        
+        /**
+         @brief Returns original with its ctype<char> facet replaced by a
+         container_ctype for format.
+         @details The resulting locales are cached per thread, keyed by
+         original and the two characters container_ctype depends on, so that
+         reading a container does not build a new mask table and locale.
+         Unnamed locales compare equal only to copies of themselves, so that
+         nested reads, whose original is itself a cached locale, hit the
+         cache as well.
+         */
+        inline std::locale container_locale(
+            const std::locale& original,
+            const container_format_values& format)
+        {
+            struct entry
+            {
+                std::locale mOriginal;
+                char mDel;
+                char mRight;
+                std::locale mLocale;
+            };
+            static const std::size_t max_entries = 32;
+            thread_local std::vector<entry> cache;
+            
+            for (const entry& e : cache) {
+                if (e.mDel == format.mDel && e.mRight == format.mRight && e.mOriginal == original) {
+                    return e.mLocale;
+                }
+            }
+            if (cache.size() == max_entries) { cache.erase(cache.begin()); }
+            cache.push_back({original, format.mDel, format.mRight,
+                             std::locale(original, new container_ctype(format))});
+            return cache.back().mLocale;
+        }
 
         /**
          @brief Helper class for checking a prefix of the associated input
@@ -71,10 +111,7 @@ namespace utils
                 /// delimiters can be read as part of a T value. It
                 /// introduces the problem that a sequence of delimiters
                 /// in the input is not recognized as an invalid format.
-                mInStream.imbue(std::locale(
-                    mOriginalLoc,
-                    new container_ctype(mFormat))
-                );
+                mInStream.imbue(container_locale(mOriginalLoc, mFormat));
             }
             
             istream_format_checker(const istream_format_checker&) = default;
@@ -125,7 +162,23 @@ namespace utils
                     mNeedDel = true;
                     return true;
                 }
-                DEBUG("read_value() == false");
+                UTILS_LOG_DEBUG(logging::module::io, "read_value() == false");
+                return false;
+            }
+            
+            /**
+             @details Sets mNeedDel to true and returns true iff reading a
+             value from mInStream with the given function succeeded, i.e.
+             iff read(mInStream) returns true.
+             */
+            template<typename Reader>
+            bool read_value_with(Reader&& read)
+            {
+                if (read(mInStream)) {
+                    mNeedDel = true;
+                    return true;
+                }
+                UTILS_LOG_DEBUG(logging::module::io, "read_value_with() == false");
                 return false;
             }
             
@@ -175,7 +228,8 @@ namespace utils
                     mNeedLeft = false;
                     return true;
                 }
-                DEBUG("read_left() == false: " << static_cast<charT>(mInStream.peek()));
+                UTILS_LOG_DEBUG(logging::module::io,
+                                "read_left() == false: " << static_cast<charT>(mInStream.peek()));
                 return false;
             }
             
@@ -191,7 +245,8 @@ namespace utils
                     mNeedDel = false;
                     return true;
                 }
-                DEBUG("read_del() == false: " << static_cast<charT>(mInStream.peek()));
+                UTILS_LOG_DEBUG(logging::module::io,
+                                "read_del() == false: " << static_cast<charT>(mInStream.peek()));
                 return false;
             }
 
@@ -297,9 +352,13 @@ namespace utils
              @brief Increment iterator position.
              @todo Reading multiple consecutive mDel's should yield an error.
              @todo Reading mFormat.mDel when !mNeedDel should yield an error.
+             @note mValue is reset before reading the next value, such that
+             values that are containers themselves do not accumulate the
+             elements of previously read values.
              */
             container_istream_iterator& operator++()
             {
+                mValue = T();
                 if (mInStream == nullptr ||
                     /* AND */ (mFormatChecker->read_left_iff_required() &&
                                /* OR */ (mFormatChecker->read_right() ||
@@ -338,42 +397,148 @@ namespace utils
             }
         }; // end class template container_istream_iterator
         
-        // READ_VALUE
+        // READ_SIZE_PREFIX
         
-        template<typename T>
-        struct unconst
+        /**
+         @brief Reads the optional size prefix of a container, i.e. the 
+         number of elements written in decimal digits directly before the 
+         container's mLeft. Returns true iff a size prefix was read and
+         sets failbit if it does not fit into a std::size_t.
+         */
+        inline bool read_size_prefix(std::istream& is, std::size_t& size)
         {
-            using type = T;
-        };
+            if (!is.good()) { return false; }
+            streambuf_source source(*is.rdbuf());
+            container_scanner<streambuf_source> scanner(source);
+            const bool sized = scanner.read_size_prefix(size);
+            is.setstate(scanner.state());
+            return sized;
+        }
+        
+        // READ_ELEMENTS
         
-        template<typename T>
-        struct unconst<const T>
+        /**
+         @brief Reads the elements of a container with the given format from
+         is into inserter, using container_istream_iterators. Returns the
+         number of elements read.
+         */
+        template<typename T, typename Format, typename Inserter>
+        std::size_t read_elements(
+            std::istream& is,
+            const Format& format,
+            Inserter& inserter,
+            std::false_type /* scannable */)
         {
-            using type = T;
-        };
+            std::size_t count = 0;
+            for (container_istream_iterator<T> it(is, format), end; it != end; ++it) {
+                inserter.insert(*it);
+                ++count;
+            }
+            return count;
+        }
         
         /**
-         @details The default read_value::type for a Container is its
-         value_type.
+         @brief Reads the elements of a container with the given format from
+         is into inserter, using a container_scanner on the stream's buffer
+         if the stream's formatting state allows for it. Returns the number
+         of elements read.
+         @details The container_scanner accepts the same input as the
+         container_istream_iterator, but does not imbue a container_ctype
+         and converts values without going through the stream's num_get.
+         For a compile-time format<...>, the scanner is specialized on its
+         characters.
          */
-        template<typename Container>
-        struct read_value
+        template<typename T, typename Format, typename Inserter>
+        std::size_t read_elements(
+            std::istream& is,
+            const Format& format,
+            Inserter& inserter,
+            std::true_type /* scannable */)
         {
-            using type = typename Container::value_type;
-        };
+            if (!is_scannable_stream(is)) {
+                return read_elements<T>(is, format, inserter, std::false_type{});
+            }
+            const std::istream::sentry ok(is, true);
+            if (!ok) {
+                is.setstate(std::ios::failbit);
+                return 0;
+            }
+            std::size_t count = 0;
+            streambuf_source source(*is.rdbuf());
+            container_scanner<streambuf_source> scanner(source);
+            scanner.template read_elements<T>(
+                format,
+                [&inserter, &count] (T& value) {
+                    inserter.insert(std::move(value));
+                    ++count;
+                }
+            );
+            is.setstate(scanner.state());
+            return count;
+        }
+        
+        // SCAN_PAIR
+        
+        template<typename T1, typename T2>
+        bool scan_pair(std::istream&, std::pair<T1,T2>&, std::false_type /* scannable */)
+        {
+            return false;
+        }
         
         /**
-         @details The read_value::type for a std::unordered_map<TKey,TVal>
-         is a std::pair<unconst<TKey>::type,TVal>, because the template
-         function overloading operator<< for std::pair<T1,_> assigns the
-         read value to the pair argument's first element, which is not
-         allowed if that element is of type const _.
+         @brief Reads P from is using a container_scanner on the stream's
+         buffer iff the stream's formatting state allows for it. Returns 
+         whether P was read this way.
          */
-        template<typename TKey, typename TVal>
-        struct read_value<std::unordered_map<TKey,TVal>>
+        template<typename T1, typename T2>
+        bool scan_pair(std::istream& is, std::pair<T1,T2>& P, std::true_type /* scannable */)
         {
-            using type = std::pair<typename unconst<TKey>::type,TVal>;
-        };
+            if (!is_scannable_stream(is)) {
+                return false;
+            }
+            const std::istream::sentry ok(is, true);
+            if (ok) {
+                streambuf_source source(*is.rdbuf());
+                container_scanner<streambuf_source> scanner(source);
+                scanner.read_pair(P);
+                is.setstate(scanner.state());
+            }
+            else { is.setstate(std::ios::failbit); }
+            return true;
+        }
+        
+        // READ_CONTAINER
+        
+        /**
+         @brief Reads C from is in the given format, which is either a
+         container_format_values or a compile-time format<...>. The elements
+         of C are read in their default formats (see operator>>).
+         */
+        template<typename Container, typename Format>
+        std::istream& read_container(std::istream& is, Container& C, const Format& format)
+        {
+            using T = typename read_value<Container>::type;
+            static_assert(!refers_to_source<T>::value,
+                "boost::string_view elements refer to the memory they are read from and cannot "
+                "be read from a stream: use read_from_memory");
+            if (format.mLeft != ' ') { is >> std::ws; }
+            container_inserter<Container> inserter(C);
+            std::size_t size = 0;
+            const bool sized = read_size_prefix(is, size);
+            if (sized && !is.fail()) { inserter.reserve(size); }
+            const std::size_t count = read_elements<T>(is, format, inserter, is_scannable_value<T>{});
+            if (!inserter.finish() || (sized && count != size)) { is.setstate(std::ios::failbit); }
+            return is;
+        }
+        
+        /**
+         @brief Reads the referenced container in Format (see with_format).
+         */
+        template<typename Format, typename Container>
+        std::istream& operator>>(std::istream& is, formatted<Format, Container> F)
+        {
+            return read_container(is, F.mContainer, Format{});
+        }
         
     } // end namespace utils.io
 } // end namespace utils
@@ -385,12 +550,17 @@ namespace std
     /**
      @brief Function template overloading operator>> for supported Containers.
 
-     @details Template instance for Container uses std::copy with
+     @details Template instance for Container reads elements with
      container_istream_iterators instantiated for the read_value::type
-     and container_format associated with Container.
+     and container_format associated with Container. Containers of
+     arithmetic values and pairs of them are read with a container_scanner
+     instead (see read_elements). Read elements are appended to C by the
+     container_inserter associated with Container.
+     
+     The container may be preceded by its number of elements, e.g. 
+     3<1,2,3>, in which case C is reserved for that many elements and
+     failbit is set if the number of elements read differs.
      
-     @note The implementation uses std::inserter, which may be slower
-     than a specialized inserter (e.g. std::back_inserter) for Container.
      @note This function template cannot be instantiated with containers
      that hold const T, because of the default allocator used for
      insertion.
@@ -402,24 +572,22 @@ namespace std
     >::type
     operator>>(std::istream& is, Container& C)
     {
-        using T = typename read_value<Container>::type;
         container_format<Container> F{};
-        if (F.mFormat.mLeft != ' ') { is >> std::ws; }
-        std::copy(
-            container_istream_iterator<T>(is, F.mFormat),
-            container_istream_iterator<T>(),
-            std::inserter(C, C.begin())
-         );
-        return is;
+        return read_container(is, C, F.mFormat);
     }
     
     /**
      @brief Function template overloading operator>> for std::pair.
      @note The implementation does not use the container_istream_iterator.
+     Pairs of arithmetic values are read with a container_scanner.
      */
     template<typename T1, typename T2>
     std::istream& operator>>(std::istream& is, std::pair<T1,T2>& P)
     {
+        static_assert(!refers_to_source<std::pair<T1,T2>>::value,
+            "boost::string_view values refer to the memory they are read from and cannot be "
+            "read from a stream: use read_from_memory");
+        if (scan_pair(is, P, is_scannable_value<std::pair<T1,T2>>{})) { return is; }
         container_format<std::pair<T1,T2>> F{};
         istream_format_checker<char,std::char_traits<char>> C(is, F.mFormat);
         if (C.read_left_iff_required() &&
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "container_format.hpp"   // includes STL containers
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+//--------------------------------------------------------------------------------------------------
+/// @file container_inserter.hpp
+/// @brief Per-container strategies for inserting elements read by the container operator>> at
+/// the end of a container, in input order.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace io {
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief The maximal number of elements reserved for a size prefix, which comes from the input.
+/// Containers with more elements grow as they are read, and a bogus prefix fails the read instead
+/// of exhausting memory.
+constexpr std::size_t max_reserve = std::size_t(1) << 24;
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief By default, elements are inserted with the end of the container as hint. For ordered
+/// containers (std::set, std::map and their multi variants) fed sorted input, this makes each
+/// insertion amortized constant, and equivalent keys of multi containers keep their input order.
+
+template <typename Container>
+class container_inserter
+{
+public:
+   explicit container_inserter(Container& container)
+   : m_container(container)
+   {
+   }
+
+   /// @brief Prepares the container for the insertion of size more elements.
+
+   void reserve(std::size_t)
+   {
+   }
+
+   template <typename T>
+   void insert(T&& value)
+   {
+      m_container.insert(m_container.end(), std::forward<T>(value));
+   }
+
+   /// @brief Returns whether the inserted elements form a valid container.
+
+   bool finish()
+   {
+      return true;
+   }
+
+private:
+   Container& m_container;
+
+};   // end class template container_inserter
+
+//--------------------------------------------------------------------------------------------------
+
+template <typename T, std::size_t N>
+class container_inserter<std::array<T, N>>
+{
+public:
+   explicit container_inserter(std::array<T, N>& array)
+   : m_array(array)
+   , m_index(0)
+   {
+   }
+
+   void reserve(std::size_t)
+   {
+   }
+
+   template <typename U>
+   void insert(U&& value)
+   {
+      if (m_index < N)
+         m_array[m_index] = std::forward<U>(value);
+      ++m_index;
+   }
+
+   /// @details A std::array is only read successfully if exactly N elements were inserted.
+
+   bool finish()
+   {
+      return m_index == N;
+   }
+
+private:
+   std::array<T, N>& m_array;
+
+   std::size_t m_index;
+
+};   // end class template container_inserter<std::array>
+
+//--------------------------------------------------------------------------------------------------
+
+template <typename T, typename Allocator>
+class container_inserter<std::forward_list<T, Allocator>>
+{
+public:
+   using container_t = std::forward_list<T, Allocator>;
+
+   explicit container_inserter(container_t& list)
+   : m_list(list)
+   , m_last(list.before_begin())
+   {
+      for (auto it = m_list.begin(); it != m_list.end(); ++it)
+         m_last = it;
+   }
+
+   void reserve(std::size_t)
+   {
+   }
+
+   template <typename U>
+   void insert(U&& value)
+   {
+      m_last = m_list.insert_after(m_last, std::forward<U>(value));
+   }
+
+   bool finish()
+   {
+      return true;
+   }
+
+private:
+   container_t& m_list;
+
+   /// @brief The last element of m_list, or its before_begin() if it is empty.
+   typename container_t::iterator m_last;
+
+};   // end class template container_inserter<std::forward_list>
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Unordered containers are reserved for the number of elements announced by a size prefix,
+/// so that reading does not rehash, and elements are emplaced without a hint.
+
+template <typename Container>
+class unordered_container_inserter
+{
+public:
+   explicit unordered_container_inserter(Container& container)
+   : m_container(container)
+   {
+   }
+
+   void reserve(std::size_t size)
+   {
+      m_container.reserve(m_container.size() + std::min(size, max_reserve));
+   }
+
+   template <typename U>
+   void insert(U&& value)
+   {
+      m_container.emplace(std::forward<U>(value));
+   }
+
+   bool finish()
+   {
+      return true;
+   }
+
+private:
+   Container& m_container;
+
+};   // end class template unordered_container_inserter
+
+template <typename TKey, typename TVal, typename Hash, typename KeyEqual, typename Allocator>
+class container_inserter<std::unordered_map<TKey, TVal, Hash, KeyEqual, Allocator>>
+: public unordered_container_inserter<std::unordered_map<TKey, TVal, Hash, KeyEqual, Allocator>>
+{
+public:
+   using unordered_container_inserter<
+      std::unordered_map<TKey, TVal, Hash, KeyEqual, Allocator>>::unordered_container_inserter;
+};
+
+template <typename TKey, typename TVal, typename Hash, typename KeyEqual, typename Allocator>
+class container_inserter<std::unordered_multimap<TKey, TVal, Hash, KeyEqual, Allocator>>
+: public unordered_container_inserter<
+     std::unordered_multimap<TKey, TVal, Hash, KeyEqual, Allocator>>
+{
+public:
+   using unordered_container_inserter<
+      std::unordered_multimap<TKey, TVal, Hash, KeyEqual, Allocator>>::unordered_container_inserter;
+};
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator>
+class container_inserter<std::unordered_set<T, Hash, KeyEqual, Allocator>>
+: public unordered_container_inserter<std::unordered_set<T, Hash, KeyEqual, Allocator>>
+{
+public:
+   using unordered_container_inserter<
+      std::unordered_set<T, Hash, KeyEqual, Allocator>>::unordered_container_inserter;
+};
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator>
+class container_inserter<std::unordered_multiset<T, Hash, KeyEqual, Allocator>>
+: public unordered_container_inserter<std::unordered_multiset<T, Hash, KeyEqual, Allocator>>
+{
+public:
+   using unordered_container_inserter<
+      std::unordered_multiset<T, Hash, KeyEqual, Allocator>>::unordered_container_inserter;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/// @details A std::deque grows in fixed-size blocks, so it needs no reservation.
+
+template <typename T, typename Allocator>
+class container_inserter<std::deque<T, Allocator>>
+{
+public:
+   using container_t = std::deque<T, Allocator>;
+
+   explicit container_inserter(container_t& deque)
+   : m_deque(deque)
+   {
+   }
+
+   void reserve(std::size_t)
+   {
+   }
+
+   template <typename U>
+   void insert(U&& value)
+   {
+      m_deque.push_back(std::forward<U>(value));
+   }
+
+   bool finish()
+   {
+      return true;
+   }
+
+private:
+   container_t& m_deque;
+
+};   // end class template container_inserter<std::deque>
+
+//--------------------------------------------------------------------------------------------------
+
+template <typename T, typename Allocator>
+class container_inserter<std::vector<T, Allocator>>
+{
+public:
+   using container_t = std::vector<T, Allocator>;
+
+   explicit container_inserter(container_t& vector)
+   : m_vector(vector)
+   {
+   }
+
+   /// @details Without a reservation, push_back grows the vector geometrically.
+
+   void reserve(std::size_t size)
+   {
+      m_vector.reserve(m_vector.size() + std::min(size, max_reserve));
+   }
+
+   template <typename U>
+   void insert(U&& value)
+   {
+      m_vector.push_back(std::forward<U>(value));
+   }
+
+   bool finish()
+   {
+      return true;
+   }
+
+private:
+   container_t& m_vector;
+
+};   // end class template container_inserter<std::vector>
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace io
+}   // end namespace utils
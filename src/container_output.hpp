@@ -3,6 +3,8 @@
 #define CONTAINER_OUTPUT_HPP_INCLUDED
 
 #include <iterator>
+#include <ostream>
+#include "charconv.hpp"
 #include "container_format.hpp" // includes STL containers
 
 /*---------------------------------------------------------------------------75*/
@@ -57,7 +59,7 @@ namespace utils
             // CTORS / DTOR
             
             container_ostream_iterator(ostream_type& os, const charT* delim=0)
-            : mOutStream(os)
+            : mOutStream(&os)
             , mDelim(delim)
             , mOutputDelim(false) { }
             
@@ -67,14 +69,14 @@ namespace utils
             
             // OPERATORS
             
-            container_ostream_iterator& operator=(const container_ostream_iterator&) = delete;
-            container_ostream_iterator& operator=(container_ostream_iterator&&) = delete;
+            container_ostream_iterator& operator=(const container_ostream_iterator&) = default;
+            container_ostream_iterator& operator=(container_ostream_iterator&&) = default;
             
             container_ostream_iterator<T>& operator=(const T& t)
             {
-                if (mOutputDelim)   { mOutStream << *mDelim;    }
+                if (mOutputDelim)   { *mOutStream << *mDelim;   }
                 else                { mOutputDelim = true;      }
-                mOutStream << t;
+                *mOutStream << t;
                 return *this;
             }
             
@@ -98,8 +100,10 @@ namespace utils
             
             // DATA MEMBERS
             
-            /// @brief The associated output stream.
-            ostream_type& mOutStream;
+            /// @brief The associated output stream (a pointer, so that the
+            /// iterator is assignable, as algorithms like std::copy over a
+            /// std::deque require).
+            ostream_type* mOutStream;
             
             /// @brief Delimiter to produce between two elements.
             const charT* mDelim;
@@ -108,7 +112,93 @@ namespace utils
             bool mOutputDelim = false;
             
         }; // end class template container_ostream_iterator
+        
+        // SIZE PREFIX
+        
+        /**
+         @brief Index of the ios_base::iword that determines whether
+         containers are written with a size prefix.
+         */
+        inline int size_prefix_index()
+        {
+            static const int index = std::ios_base::xalloc();
+            return index;
+        }
+        
+        /**
+         @brief Manipulator making subsequent container output on os
+         include a size prefix, e.g. 3<1,2,3>, which operator>> uses to
+         reserve the destination container.
+         */
+        inline std::ostream& size_prefix(std::ostream& os)
+        {
+            os.iword(size_prefix_index()) = 1;
+            return os;
+        }
+        
+        /**
+         @brief Manipulator undoing size_prefix.
+         */
+        inline std::ostream& no_size_prefix(std::ostream& os)
+        {
+            os.iword(size_prefix_index()) = 0;
+            return os;
+        }
+        
+        template<typename Container>
+        std::size_t container_size(const Container& C)
+        {
+            return C.size();
+        }
+        
+        template<typename T, typename Allocator>
+        std::size_t container_size(const std::forward_list<T, Allocator>& C)
+        {
+            return static_cast<std::size_t>(std::distance(C.begin(), C.end()));
+        }
+        
+        /**
+         @brief Writes the size of C to os iff size_prefix is set on os.
+         */
+        template<typename Container>
+        void write_size_prefix(std::ostream& os, const Container& C)
+        {
+            if (os.iword(size_prefix_index()) != 0) {
+                char buffer[std::numeric_limits<std::size_t>::digits10 + 1];
+                const to_chars_result result =
+                    to_chars(buffer, buffer + sizeof(buffer), container_size(C));
+                os.write(buffer, result.ptr - buffer);
+            }
+        }
 
+        // WRITE_CONTAINER
+        
+        /**
+         @brief Writes C to os in the given format, which is either a
+         container_format_values or a compile-time format<...>. The elements
+         of C are written in their default formats (see operator<<).
+         */
+        template<typename Container, typename Format>
+        std::ostream& write_container(std::ostream& os, const Container& C, const Format& format)
+        {
+            using T = typename Container::value_type;
+            const char del = format.mDel;
+            write_size_prefix(os, C);
+            os << format.mLeft;
+            std::copy(C.begin(), C.end(), container_ostream_iterator<T>(os, &del));
+            os << format.mRight;
+            return os;
+        }
+        
+        /**
+         @brief Writes the referenced container in Format (see with_format).
+         */
+        template<typename Format, typename Container>
+        std::ostream& operator<<(std::ostream& os, const formatted<Format, Container>& F)
+        {
+            return write_container(os, F.mContainer, Format{});
+        }
+        
     } // end namespace utils.io
 } // end namespace utils
 
@@ -120,6 +210,7 @@ namespace std
      @brief Function template overloading operator<< for supported Containers.
      @details Template instance for Container uses std::copy with an
      container_ostream_iterator instantiated for Container::value_type.
+     The container is preceded by its size iff size_prefix is set on os.
      */
     template<typename Container>
     typename std::enable_if<
@@ -128,16 +219,8 @@ namespace std
     >::type
     operator<<(std::ostream& os, const Container& C)
     {
-        using T = typename Container::value_type;
         container_format<Container> F{};
-        os << F.mFormat.mLeft;
-        std::copy(
-            C.begin(),
-            C.end(),
-            container_ostream_iterator<T>(os, &(F.mFormat.mDel))
-        );
-        os << F.mFormat.mRight;
-        return os;
+        return write_container(os, C, F.mFormat);
     }
     
     /**
@@ -0,0 +1,739 @@
+#pragma once
+
+#include "charconv.hpp"
+#include "container_format.hpp"
+#include "container_inserter.hpp"
+#include "logging.hpp"
+
+#include <boost/utility/string_view.hpp>
+
+#include <ios>
+#include <istream>
+#include <limits>
+#include <locale>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+//--------------------------------------------------------------------------------------------------
+/// @file container_scanner.hpp
+/// @brief Locale-free reader for containers of arithmetic values, strings and pairs of them that
+/// consumes characters directly from a character source instead of going through formatted
+/// istream extraction.
+/// @details The scanner accepts exactly the grammar implemented by container_istream_iterator
+/// and istream_format_checker: while reading an element, classic whitespace as well as the
+/// delimiter and right bracket of the enclosing format are skipped (cf. container_ctype), and
+/// arithmetic values follow the num_get grammar of the "C" locale.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace io {
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Character source reading directly from a std::streambuf.
+
+class streambuf_source
+{
+public:
+   using int_type = std::char_traits<char>::int_type;
+
+   explicit streambuf_source(std::streambuf& buffer)
+   : m_buffer(buffer)
+   {
+   }
+
+   /// @brief Returns the next character as an unsigned char converted to int_type, or eof()
+   /// without consuming it.
+
+   int_type peek()
+   {
+      return m_buffer.sgetc();
+   }
+
+   void bump()
+   {
+      m_buffer.sbumpc();
+   }
+
+   static constexpr int_type eof()
+   {
+      return std::char_traits<char>::eof();
+   }
+
+private:
+   std::streambuf& m_buffer;
+
+};   // end class streambuf_source
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Character source reading from a contiguous range of characters in memory, e.g. a
+/// mapped_file. Values of type boost::string_view can only be read from this source and refer to
+/// the underlying memory.
+
+class memory_source
+{
+public:
+   using int_type = std::char_traits<char>::int_type;
+
+   memory_source(const char* first, const char* last)
+   : m_pos(first)
+   , m_last(last)
+   {
+   }
+
+   int_type peek() const
+   {
+      return m_pos != m_last ? std::char_traits<char>::to_int_type(*m_pos) : eof();
+   }
+
+   void bump()
+   {
+      ++m_pos;
+   }
+
+   static constexpr int_type eof()
+   {
+      return std::char_traits<char>::eof();
+   }
+
+   /// @brief Returns a pointer to the next character.
+
+   const char* position() const
+   {
+      return m_pos;
+   }
+
+private:
+   const char* m_pos;
+   const char* m_last;
+
+};   // end class memory_source
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief By default, T cannot be read by the container_scanner.
+
+template <typename T>
+struct is_scannable_value : public std::false_type
+{
+};
+
+template <>
+struct is_scannable_value<bool> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<char> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<signed char> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<unsigned char> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<short> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<unsigned short> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<int> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<unsigned int> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<long> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<unsigned long> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<long long> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<unsigned long long> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<float> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<double> : public std::true_type
+{
+};
+
+template <>
+struct is_scannable_value<long double> : public std::true_type
+{
+};
+
+template <typename Traits, typename Allocator>
+struct is_scannable_value<std::basic_string<char, Traits, Allocator>> : public std::true_type
+{
+};
+
+/// @brief Pairs of scannable values can be read by the container_scanner.
+
+template <typename T1, typename T2>
+struct is_scannable_value<std::pair<T1, T2>>
+   : public std::integral_constant<bool, is_scannable_value<T1>::value &&
+                                            is_scannable_value<T2>::value>
+{
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Values the container_scanner can read from Source: the scannable values, and, from a
+/// memory_source, values of type boost::string_view that refer to the source's memory.
+
+template <typename T, typename Source>
+struct is_scannable_from : public is_scannable_value<T>
+{
+};
+
+template <>
+struct is_scannable_from<boost::string_view, memory_source> : public std::true_type
+{
+};
+
+template <typename T1, typename T2, typename Source>
+struct is_scannable_from<std::pair<T1, T2>, Source>
+   : public std::integral_constant<bool, is_scannable_from<T1, Source>::value &&
+                                            is_scannable_from<T2, Source>::value>
+{
+};
+
+/// @brief Supported containers of values the container_scanner can read from Source.
+
+template <typename T, typename Source = streambuf_source>
+struct is_scannable_container
+   : public std::integral_constant<
+        bool, supported_container<T>::value &&
+                 is_scannable_from<typename read_value<T>::type, Source>::value>
+{
+};
+
+/// @brief Whether T is or contains values of type boost::string_view, which refer to the memory
+/// they are read from and can therefore only be read from memory (see read_from_memory), not
+/// from a stream.
+
+template <typename T, typename = void>
+struct refers_to_source : public std::false_type
+{
+};
+
+template <>
+struct refers_to_source<boost::string_view> : public std::true_type
+{
+};
+
+template <typename T1, typename T2>
+struct refers_to_source<std::pair<T1, T2>>
+   : public std::integral_constant<bool, refers_to_source<T1>::value ||
+                                            refers_to_source<T2>::value>
+{
+};
+
+template <typename T>
+struct refers_to_source<T, typename std::enable_if<supported_container<T>::value>::type>
+   : public refers_to_source<typename read_value<T>::type>
+{
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Returns whether formatted extraction of values from is behaves like the
+/// container_scanner, i.e. is uses decimal base, skips whitespace, does not read booleans
+/// alphabetically, has no field width set and its locale uses '.' as decimal point without digit
+/// grouping.
+
+inline bool is_scannable_stream(const std::istream& is)
+{
+   const std::ios_base::fmtflags flags = is.flags();
+   if ((flags & std::ios_base::basefield) != std::ios_base::dec ||
+       !(flags & std::ios_base::skipws) || (flags & std::ios_base::boolalpha) || is.width() != 0)
+      return false;
+   const auto& numpunct = std::use_facet<std::numpunct<char>>(is.getloc());
+   return numpunct.decimal_point() == '.' && numpunct.grouping().empty();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Reads containers in the container_format grammar from a character source.
+/// @details Errors are accumulated in an iostate, which the caller transfers to the stream the
+/// source reads from.
+
+template <typename Source>
+class container_scanner
+{
+public:
+   using int_type = typename Source::int_type;
+
+   explicit container_scanner(Source& source)
+   : m_source(source)
+   , m_state(std::ios_base::goodbit)
+   {
+   }
+
+   std::ios_base::iostate state() const
+   {
+      return m_state;
+   }
+
+   /// @brief Reads a supported container the way operator>> does from a stream with the classic
+   /// locale: skips whitespace, reads an optional size prefix and the container's elements.
+   /// Returns false and sets failbit if the input does not match.
+
+   template <typename Container>
+   bool read_container(Container& container)
+   {
+      const container_format<Container> format{};
+      container_inserter<Container> inserter(container);
+      std::size_t size = 0;
+      const bool sized = read_container_prefix(format.mFormat, size);
+      if (sized)
+      {
+         if (m_state & std::ios_base::failbit)
+            return false;
+         inserter.reserve(size);
+      }
+      std::size_t count = 0;
+      using T = typename read_value<Container>::type;
+      if (!read_elements<T>(format.mFormat, [&inserter, &count](T& value) {
+             inserter.insert(std::move(value));
+             ++count;
+          }))
+         return false;
+      if (!inserter.finish() || (sized && count != size))
+         return fail();
+      return true;
+   }
+
+   /// @brief Skips whitespace like std::ws on a stream with the classic locale and reads the
+   /// optional size prefix of a container with the given format. Returns true iff a size prefix
+   /// was read.
+
+   template <typename Format>
+   bool read_container_prefix(const Format& format, std::size_t& size)
+   {
+      if (format.mLeft != ' ')
+         skip_space(classic_context());
+      return read_size_prefix(size);
+   }
+
+   /// @brief Reads the optional size prefix of a container, i.e. its number of elements written in
+   /// decimal digits. Returns true iff a size prefix was read and sets failbit if it does not fit
+   /// into a std::size_t.
+
+   bool read_size_prefix(std::size_t& size)
+   {
+      if (!is_digit(m_source.peek()))
+         return false;
+      unsigned long long magnitude;
+      if (!read_magnitude(magnitude, std::numeric_limits<std::size_t>::max()))
+         fail();
+      size = static_cast<std::size_t>(magnitude);
+      return true;
+   }
+
+   /// @brief Reads format.mLeft, elements of type T separated by format.mDel and format.mRight,
+   /// passing each element to insert. Returns false and sets failbit if the input does not match.
+
+   template <typename T, typename Format, typename Inserter>
+   bool read_elements(const Format& format, Inserter&& insert)
+   {
+      if (!read_left(format))
+         return false;
+      const element_context<Format> context(format);
+      bool need_del = false;
+      T value{};
+      while (!read_char(format.mRight))
+      {
+         if (need_del && !read_char(format.mDel))
+         {
+            UTILS_LOG_DEBUG(logging::module::io,
+                            "read_del() == false: " << static_cast<char>(m_source.peek()));
+            return fail();
+         }
+         if (!read_value(value, context))
+         {
+            UTILS_LOG_DEBUG(logging::module::io, "read_value() == false");
+            return fail();
+         }
+         insert(value);
+         need_del = true;
+      }
+      return true;
+   }
+
+   /// @brief Reads format.mLeft. Returns false and sets failbit if the input does not match.
+
+   template <typename Format>
+   bool read_left(const Format& format)
+   {
+      if (read_char(format.mLeft))
+         return true;
+      UTILS_LOG_DEBUG(logging::module::io,
+                      "read_left() == false: " << static_cast<char>(m_source.peek()));
+      return fail();
+   }
+
+   /// @brief Reads one or more elements of type T separated by format.mDel up to the end of the
+   /// source, passing each element to insert. Returns false and sets failbit if the input does not
+   /// match.
+   /// @details Reads a part of a container's elements that was split off at a delimiter between
+   /// two elements.
+
+   template <typename T, typename Format, typename Inserter>
+   bool read_element_sequence(const Format& format, Inserter&& insert)
+   {
+      const element_context<Format> context(format);
+      T value{};
+      while (true)
+      {
+         if (!read_value(value, context))
+            return fail();
+         insert(value);
+         if (m_source.peek() == Source::eof())
+            return true;
+         if (!read_char(format.mDel))
+            return fail();
+      }
+   }
+
+   /// @brief Reads one or more elements of type T separated by format.mDel followed by
+   /// format.mRight, passing each element to insert. Returns false and sets failbit if the input
+   /// does not match.
+   /// @details Reads the last part of a container's elements that was split off at a delimiter
+   /// between two elements.
+
+   template <typename T, typename Format, typename Inserter>
+   bool read_last_elements(const Format& format, Inserter&& insert)
+   {
+      const element_context<Format> context(format);
+      T value{};
+      while (true)
+      {
+         if (!read_value(value, context))
+            return fail();
+         insert(value);
+         if (read_char(format.mRight))
+            return true;
+         if (!read_char(format.mDel))
+            return fail();
+      }
+   }
+
+   /// @brief Reads a std::pair in its container_format. Returns false and sets failbit if the
+   /// input does not match.
+
+   template <typename T1, typename T2>
+   bool read_pair(std::pair<T1, T2>& pair)
+   {
+      const container_format<std::pair<T1, T2>> format{};
+      const element_context<decltype(format.mFormat)> context(format.mFormat);
+      if (read_char(format.mFormat.mLeft) && read_value(pair.first, context) &&
+          read_char(format.mFormat.mDel) && read_value(pair.second, context) &&
+          read_char(format.mFormat.mRight))
+         return true;
+      return fail();
+   }
+
+private:
+   /// @brief The characters that are treated as whitespace while reading an element of a
+   /// container with the given format (cf. container_ctype). For a compile-time format<...>, the
+   /// checks are against constants.
+
+   template <typename Format>
+   class element_context
+   {
+   public:
+      explicit element_context(const Format& format = Format())
+      : m_format(format)
+      {
+      }
+
+      bool is_space(const int_type c) const
+      {
+         return c == ' ' || (c >= '\t' && c <= '\r') ||
+                c == std::char_traits<char>::to_int_type(m_format.mDel) ||
+                c == std::char_traits<char>::to_int_type(m_format.mRight);
+      }
+
+   private:
+      Format m_format;
+   };
+
+   /// @brief Context in which only classic whitespace is skipped.
+   using classic_context = element_context<format<' ', ' ', ' '>>;
+
+   Source& m_source;
+
+   std::ios_base::iostate m_state;
+
+   /// @brief Token buffer for floating-point values, reused across elements.
+   std::string m_token;
+
+   bool fail()
+   {
+      m_state |= std::ios_base::failbit;
+      return false;
+   }
+
+   static bool is_digit(const int_type c)
+   {
+      return c >= '0' && c <= '9';
+   }
+
+   /// @brief Returns the next character, setting eofbit if there is none.
+
+   int_type peek()
+   {
+      const int_type c = m_source.peek();
+      if (c == Source::eof())
+         m_state |= std::ios_base::eofbit;
+      return c;
+   }
+
+   /// @brief Consumes the next character and returns true iff it equals expected.
+
+   bool read_char(const char expected)
+   {
+      if (peek() == std::char_traits<char>::to_int_type(expected))
+      {
+         m_source.bump();
+         return true;
+      }
+      return false;
+   }
+
+   /// @brief Skips whitespace in the given context and returns the first other character, like
+   /// the sentry of a formatted input operation.
+
+   template <typename Context>
+   int_type skip_space(const Context& context)
+   {
+      int_type c = peek();
+      while (c != Source::eof() && context.is_space(c))
+      {
+         m_source.bump();
+         c = peek();
+      }
+      return c;
+   }
+
+   /// @brief Consumes an optional sign and returns true iff it is '-'.
+
+   bool read_sign()
+   {
+      const int_type c = peek();
+      if (c == '-' || c == '+')
+      {
+         m_source.bump();
+         return c == '-';
+      }
+      return false;
+   }
+
+   /// @brief Reads the longest sequence of decimal digits into the magnitude of an integer.
+   /// Returns false if there is no digit or the magnitude exceeds max.
+
+   bool read_magnitude(unsigned long long& magnitude, const unsigned long long max)
+   {
+      magnitude = 0;
+      bool found_digit = false;
+      bool overflow = false;
+      for (int_type c = peek(); is_digit(c); c = peek())
+      {
+         const unsigned long long digit = static_cast<unsigned long long>(c - '0');
+         if (magnitude > (max - digit) / 10)
+            overflow = true;
+         else
+            magnitude = magnitude * 10 + digit;
+         found_digit = true;
+         m_source.bump();
+      }
+      return found_digit && !overflow;
+   }
+
+   template <typename T, typename Context>
+   typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                              sizeof(T) != 1,
+                           bool>::type
+   read_value(T& value, const Context& context)
+   {
+      if (skip_space(context) == Source::eof())
+         return false;
+      const bool negative = read_sign();
+      using unsigned_t = typename std::make_unsigned<T>::type;
+      const unsigned long long max =
+         (std::is_signed<T>::value && negative)
+            ? static_cast<unsigned long long>(std::numeric_limits<T>::max()) + 1
+            : static_cast<unsigned long long>(std::numeric_limits<T>::max());
+      unsigned long long magnitude;
+      if (!read_magnitude(magnitude, max))
+         return false;
+      const unsigned_t result = static_cast<unsigned_t>(magnitude);
+      value = static_cast<T>(negative ? unsigned_t(unsigned_t(0) - result) : result);
+      return true;
+   }
+
+   /// @details Without boolalpha, a bool is extracted as an integer that must equal 0 or 1.
+
+   template <typename Context>
+   bool read_value(bool& value, const Context& context)
+   {
+      long result;
+      if (!read_value(result, context) || (result != 0 && result != 1))
+         return false;
+      value = result == 1;
+      return true;
+   }
+
+   /// @details Character types are extracted as a single non-whitespace character.
+
+   template <typename T, typename Context>
+   typename std::enable_if<std::is_integral<T>::value && sizeof(T) == 1 &&
+                              !std::is_same<T, bool>::value,
+                           bool>::type
+   read_value(T& value, const Context& context)
+   {
+      const int_type c = skip_space(context);
+      if (c == Source::eof())
+         return false;
+      value = static_cast<T>(std::char_traits<char>::to_char_type(c));
+      m_source.bump();
+      return true;
+   }
+
+   /// @details Collects the longest prefix matching the num_get floating-point grammar and
+   /// requires all of it to convert.
+
+   template <typename T, typename Context>
+   typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+   read_value(T& value, const Context& context)
+   {
+      if (skip_space(context) == Source::eof())
+         return false;
+      m_token.clear();
+      if (read_sign())
+         m_token.push_back('-');
+      bool found_mantissa = false;
+      bool found_dec = false;
+      bool found_sci = false;
+      for (int_type c = peek(); c != Source::eof(); c = peek())
+      {
+         if (c == '.' && !found_dec && !found_sci)
+         {
+            found_dec = true;
+         }
+         else if (is_digit(c))
+         {
+            found_mantissa = true;
+         }
+         else if ((c == 'e' || c == 'E') && !found_sci && found_mantissa)
+         {
+            found_sci = true;
+            m_token.push_back('e');
+            m_source.bump();
+            const int_type sign = peek();
+            if (sign == '+' || sign == '-')
+            {
+               m_token.push_back(static_cast<char>(sign));
+               m_source.bump();
+            }
+            continue;
+         }
+         else
+         {
+            break;
+         }
+         m_token.push_back(static_cast<char>(c));
+         m_source.bump();
+      }
+      const char* const first = m_token.data();
+      const char* const last = first + m_token.size();
+      const from_chars_result result = from_chars(first, last, value);
+      return result.ec == std::errc() && result.ptr == last;
+   }
+
+   /// @details Strings are extracted as the longest non-empty sequence of non-whitespace
+   /// characters.
+
+   template <typename Traits, typename Allocator, typename Context>
+   bool read_value(std::basic_string<char, Traits, Allocator>& value, const Context& context)
+   {
+      int_type c = skip_space(context);
+      value.clear();
+      while (c != Source::eof() && !context.is_space(c))
+      {
+         value.push_back(std::char_traits<char>::to_char_type(c));
+         m_source.bump();
+         c = peek();
+      }
+      return !value.empty();
+   }
+
+   /// @details Like strings, but value refers to the characters in the source's memory.
+
+   template <typename Context>
+   bool read_value(boost::string_view& value, const Context& context)
+   {
+      int_type c = skip_space(context);
+      const char* const first = m_source.position();
+      while (c != Source::eof() && !context.is_space(c))
+      {
+         m_source.bump();
+         c = peek();
+      }
+      value = boost::string_view(first, static_cast<std::size_t>(m_source.position() - first));
+      return !value.empty();
+   }
+
+   /// @details Like the operator>> overload for std::pair, reading a nested pair does not skip
+   /// whitespace.
+
+   template <typename T1, typename T2, typename Context>
+   bool read_value(std::pair<T1, T2>& value, const Context&)
+   {
+      return read_pair(value);
+   }
+
+};   // end class template container_scanner
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace io
+}   // end namespace utils
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "container_input.hpp"
+
+#include <cstddef>
+#include <istream>
+#include <type_traits>
+
+//--------------------------------------------------------------------------------------------------
+/// @file container_visitor.hpp
+/// @brief Streaming reader for serialized containers that reports their elements to a visitor as
+/// they are parsed instead of materializing the container.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace io {
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Base class for visitors passed to visit_container, providing empty handlers for the
+/// enter and leave events. A visitor additionally provides an operator() taking each leaf
+/// element, i.e. each element that is not a supported container itself.
+
+struct container_visitor
+{
+   /// @brief Called when the reader starts reading the elements of a (nested) container.
+   void enter()
+   {
+   }
+
+   /// @brief Called when the reader has read all elements of a (nested) container.
+   void leave()
+   {
+   }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+/// @brief container_inserter-like adapter passing the inserted elements on to a visitor.
+
+template <typename Visitor>
+class visiting_inserter
+{
+public:
+   explicit visiting_inserter(Visitor& visitor)
+   : m_visitor(visitor)
+   {
+   }
+
+   template <typename T>
+   void insert(const T& value)
+   {
+      m_visitor(value);
+   }
+
+private:
+   Visitor& m_visitor;
+};
+
+template <typename Container, typename Visitor>
+bool visit(std::istream& is, Visitor& visitor);
+
+/// @brief Reads leaf elements one at a time, using the same readers as operator>>.
+
+template <typename T, typename Format, typename Visitor>
+std::size_t visit_elements(std::istream& is,
+                           const Format& format,
+                           Visitor& visitor,
+                           std::false_type /* nested */)
+{
+   visiting_inserter<Visitor> inserter(visitor);
+   return read_elements<T>(is, format, inserter, is_scannable_value<T>{});
+}
+
+/// @brief Reads elements that are containers themselves by visiting them recursively, following
+/// the grammar of the container_istream_iterator.
+
+template <typename T, typename Visitor>
+std::size_t visit_elements(std::istream& is,
+                           const container_format_values& format,
+                           Visitor& visitor,
+                           std::true_type /* nested */)
+{
+   istream_format_checker<char> checker(is, format);
+   std::size_t count = 0;
+   bool ok = checker.read_left_iff_required();
+   while (ok && !checker.read_right())
+   {
+      ok = checker.read_del_iff_required() &&
+           checker.read_value_with([&visitor](std::istream& in) { return visit<T>(in, visitor); });
+      if (ok)
+         ++count;
+   }
+   checker.close();
+   if (!ok)
+      is.setstate(std::ios::failbit);
+   return count;
+}
+
+/// @brief Reads a Container the way operator>> does, reporting events to visitor. Returns false
+/// iff reading failed.
+
+template <typename Container, typename Visitor>
+bool visit(std::istream& is, Visitor& visitor)
+{
+   using T = typename read_value<Container>::type;
+   const container_format<Container> format{};
+   if (format.mFormat.mLeft != ' ')
+      is >> std::ws;
+   std::size_t size = 0;
+   const bool sized = read_size_prefix(is, size);
+   if (is.fail())
+      return false;
+
+   visitor.enter();
+   const std::size_t count =
+      visit_elements<T>(is, format.mFormat, visitor, supported_container<T>{});
+   if (is.fail())
+      return false;
+   visitor.leave();
+
+   if (sized && count != size)
+   {
+      is.setstate(std::ios::failbit);
+      return false;
+   }
+   return true;
+}
+
+template <typename Function>
+class function_visitor : public container_visitor
+{
+public:
+   explicit function_visitor(Function& function)
+   : m_function(function)
+   {
+   }
+
+   template <typename T>
+   void operator()(const T& value)
+   {
+      m_function(value);
+   }
+
+private:
+   Function& m_function;
+};
+
+}   // end namespace detail
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Reads a serialized Container from is without materializing it. Calls visitor.enter()
+/// and visitor.leave() around the elements of the container and of each nested supported
+/// container, and visitor(value) for each leaf element in input order.
+/// @details Accepts the same input as operator>> and sets failbit in the same cases. Only one
+/// leaf element is held in memory at a time, so memory use does not depend on the size of the
+/// input. Supported containers nested in other types (e.g. the values of a std::unordered_map)
+/// are leaf elements and are materialized.
+/// @note When reading fails, the reported enter and leave events may not match up.
+
+template <typename Container, typename Visitor>
+std::istream& visit_container(std::istream& is, Visitor&& visitor)
+{
+   detail::visit<Container>(is, visitor);
+   return is;
+}
+
+/// @brief Reads a serialized Container from is without materializing it and calls function on
+/// each leaf element in input order (see visit_container).
+
+template <typename Container, typename Function>
+std::istream& for_each_element(std::istream& is, Function&& function)
+{
+   detail::function_visitor<typename std::remove_reference<Function>::type> visitor(function);
+   return visit_container<Container>(is, visitor);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace io
+}   // end namespace utils
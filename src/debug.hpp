@@ -1,26 +1,21 @@
 #pragma once
 
-#include <iostream>
-#include <thread>
+#include "logging.hpp"
 
 //--------------------------------------------------------------------------------------------------
 /// @file debug.hpp
-/// @brief Debugging macros.
+/// @brief Debugging macros, writing debug-level records of the general module (see logging.hpp).
+/// @details The macros compile to nothing unless UTILS_LOG_LEVEL is UTILS_LOG_LEVEL_DEBUG or
+/// lower. Records are buffered per thread, so the _SYNC variants need no lock and equal the plain
+/// ones.
 /// @author Susanne van den Elsen
 /// @date 2015-2017
 //--------------------------------------------------------------------------------------------------
 
 
-#define _DEBUG
-#ifdef _DEBUG
-#   define DEBUG(x) do { std::cout << x << std::flush; } while (false)
-#   define DEBUGF(class, method, args, other) do { std::cout << class << "::" << method << "(" << args << ")\t" << other; } while (false)
-static std::mutex debug_mutex;
-#   define DEBUG_SYNC(x) do { std::lock_guard<std::mutex> lock_guard(debug_mutex); DEBUG(x); } while (false)
-#   define DEBUGF_SYNC(class, method, args, other) do { std::lock_guard<std::mutex> lock_guard(debug_mutex); DEBUGF(class, method, args, other); } while (false)
-#else
-#   define DEBUG(x) do { } while (false)
-#   define DEBUGF(class, method, args, other) do { } while (false)
-#   define DEBUG_SYNC(x) do { } while (false)
-#   define DEBUGF_SYNC(class, method, args, other) do { } while (false)
-#endif
+#define DEBUG(x) UTILS_LOG_DEBUG(::utils::logging::module::general, x)
+#define DEBUGF(class, method, args, other)                                                         \
+   UTILS_LOG_DEBUG(::utils::logging::module::general,                                              \
+                   class << "::" << method << "(" << args << ")\t" << other)
+#define DEBUG_SYNC(x) DEBUG(x)
+#define DEBUGF_SYNC(class, method, args, other) DEBUGF(class, method, args, other)
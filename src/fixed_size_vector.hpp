@@ -2,8 +2,18 @@
 
 // UTILS
 #include "container_io.hpp"
+#include "simd.hpp"
 
 // STL
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 //--------------------------------------------------------------------------------------90
@@ -15,95 +25,615 @@
 namespace datastructures
 {
    //-------------------------------------------------------------------------------------
-   
-   // forward declarations
-   
-   template <typename T>
-   class fixed_size_vector;
-   
-   template <typename T>
-   std::ostream& operator <<(std::ostream& os, const fixed_size_vector<T>& vector);
-   
+
+   namespace detail
+   {
+      /// @brief Returns the number of elements allocated for size elements. Arithmetic
+      /// elements are padded to a whole number of lanes, so that the vectorized kernels work on
+      /// whole registers.
+
+      template <typename T>
+      std::size_t storage_capacity(std::size_t size, std::false_type /* arithmetic */)
+      {
+         return size;
+      }
+
+      template <typename T>
+      std::size_t storage_capacity(std::size_t size, std::true_type /* arithmetic */)
+      {
+         return utils::simd::padded_size<T>(size);
+      }
+
+      template <typename T>
+      std::size_t storage_capacity(std::size_t size)
+      {
+         return storage_capacity<T>(size, std::is_arithmetic<T>{});
+      }
+
+      /// @brief Allocates storage for size elements, with zeroed padding.
+
+      template <typename T, typename Allocator>
+      T* allocate_elements(Allocator& allocator, std::size_t size)
+      {
+         const std::size_t capacity = storage_capacity<T>(size);
+         T* data = std::allocator_traits<Allocator>::allocate(allocator, capacity);
+         if (capacity != size)
+         {
+            std::memset(static_cast<void*>(data + size), 0, (capacity - size) * sizeof(T));
+         }
+         return data;
+      }
+
+      template <typename T, typename Allocator>
+      void deallocate_elements(Allocator& allocator, T* data, std::size_t size)
+      {
+         std::allocator_traits<Allocator>::deallocate(allocator, data, storage_capacity<T>(size));
+      }
+
+      /// @brief Storage for the elements of a fixed_size_vector<T, N>. Up to N elements are
+      /// stored inline, more elements in a single allocation. The (typically empty) allocator
+      /// is a base class, so that it takes no space.
+
+      template <typename T, std::size_t N, typename Allocator>
+      class fixed_size_storage : private Allocator
+      {
+      public:
+
+         explicit fixed_size_storage(const Allocator& allocator)
+         : Allocator(allocator)
+         {
+         }
+
+         const Allocator& get_allocator() const
+         {
+            return *this;
+         }
+
+         T* data(std::size_t size)
+         {
+            return size <= N ? reinterpret_cast<T*>(&m_inline) : m_heap;
+         }
+
+         const T* data(std::size_t size) const
+         {
+            return size <= N ? reinterpret_cast<const T*>(&m_inline) : m_heap;
+         }
+
+         void allocate(std::size_t size)
+         {
+            if (size > N)
+            {
+               m_heap = allocate_elements<T>(allocator(), size);
+            }
+         }
+
+         void deallocate(std::size_t size)
+         {
+            if (size > N)
+            {
+               deallocate_elements(allocator(), m_heap, size);
+            }
+         }
+
+         /// @brief Whether elements are moved by moving the storage rather than one by one.
+
+         static bool owns_heap(std::size_t size)
+         {
+            return size > N;
+         }
+
+         void take_heap(fixed_size_storage& other)
+         {
+            m_heap = other.m_heap;
+         }
+
+      private:
+
+         union
+         {
+            T* m_heap;
+            typename std::aligned_storage<N * sizeof(T), alignof(T)>::type m_inline;
+         };
+
+         Allocator& allocator()
+         {
+            return *this;
+         }
+
+      }; // end class template fixed_size_storage
+
+      /// @brief Storage for the elements of a fixed_size_vector<T>, which are all stored in a
+      /// single allocation.
+
+      template <typename T, typename Allocator>
+      class fixed_size_storage<T, 0, Allocator> : private Allocator
+      {
+      public:
+
+         explicit fixed_size_storage(const Allocator& allocator)
+         : Allocator(allocator)
+         {
+         }
+
+         const Allocator& get_allocator() const
+         {
+            return *this;
+         }
+
+         T* data(std::size_t) const
+         {
+            return m_heap;
+         }
+
+         void allocate(std::size_t size)
+         {
+            m_heap = size == 0 ? nullptr : allocate_elements<T>(allocator(), size);
+         }
+
+         void deallocate(std::size_t size)
+         {
+            if (m_heap != nullptr)
+            {
+               deallocate_elements(allocator(), m_heap, size);
+            }
+         }
+
+         static bool owns_heap(std::size_t)
+         {
+            return true;
+         }
+
+         void take_heap(fixed_size_storage& other)
+         {
+            m_heap = other.m_heap;
+            other.m_heap = nullptr;
+         }
+
+      private:
+
+         T* m_heap;
+
+         Allocator& allocator()
+         {
+            return *this;
+         }
+
+      }; // end class template fixed_size_storage<T, 0>
+
+      /// @brief Arithmetic elements are aligned to utils::simd::alignment by default.
+
+      template <typename T>
+      using default_allocator = typename std::conditional<std::is_arithmetic<T>::value,
+                                                          utils::simd::aligned_allocator<T>,
+                                                          std::allocator<T>>::type;
+
+      /// @brief Element-wise operations and reductions on arrays of n elements, by the
+      /// vectorized kernels in simd.hpp for the types they are instantiated for (see
+      /// utils::simd::is_simd_type), and by plain loops for other types.
+
+      template <typename T, bool = utils::simd::is_simd_type<T>::value>
+      struct element_ops
+      {
+         static void add(const T* a, const T* b, T* out, std::size_t n)
+         {
+            utils::simd::add(a, b, out, n);
+         }
+
+         static void sub(const T* a, const T* b, T* out, std::size_t n)
+         {
+            utils::simd::sub(a, b, out, n);
+         }
+
+         static void mul(const T* a, const T* b, T* out, std::size_t n)
+         {
+            utils::simd::mul(a, b, out, n);
+         }
+
+         static void fill(T* out, std::size_t n, const T& value)
+         {
+            utils::simd::fill(out, n, value);
+         }
+
+         static void less(const T* a, const T* b, std::uint8_t* out, std::size_t n)
+         {
+            utils::simd::less(a, b, out, n);
+         }
+
+         static void equal(const T* a, const T* b, std::uint8_t* out, std::size_t n)
+         {
+            utils::simd::equal(a, b, out, n);
+         }
+
+         static T sum(const T* a, std::size_t n)
+         {
+            return utils::simd::sum(a, n);
+         }
+
+         static T min_value(const T* a, std::size_t n)
+         {
+            return utils::simd::min_value(a, n);
+         }
+
+         static T max_value(const T* a, std::size_t n)
+         {
+            return utils::simd::max_value(a, n);
+         }
+
+         static T dot(const T* a, const T* b, std::size_t n)
+         {
+            return utils::simd::dot(a, b, n);
+         }
+      };
+
+      template <typename T>
+      struct element_ops<T, false>
+      {
+         static void add(const T* a, const T* b, T* out, std::size_t n)
+         {
+            std::transform(a, a + n, b, out, std::plus<T>());
+         }
+
+         static void sub(const T* a, const T* b, T* out, std::size_t n)
+         {
+            std::transform(a, a + n, b, out, std::minus<T>());
+         }
+
+         static void mul(const T* a, const T* b, T* out, std::size_t n)
+         {
+            std::transform(a, a + n, b, out, std::multiplies<T>());
+         }
+
+         static void fill(T* out, std::size_t n, const T& value)
+         {
+            std::fill_n(out, n, value);
+         }
+
+         static void less(const T* a, const T* b, std::uint8_t* out, std::size_t n)
+         {
+            std::transform(a, a + n, b, out, [](const T& x, const T& y) {
+               return static_cast<std::uint8_t>(x < y);
+            });
+         }
+
+         static void equal(const T* a, const T* b, std::uint8_t* out, std::size_t n)
+         {
+            std::transform(a, a + n, b, out, [](const T& x, const T& y) {
+               return static_cast<std::uint8_t>(x == y);
+            });
+         }
+
+         static T sum(const T* a, std::size_t n)
+         {
+            return std::accumulate(a, a + n, T());
+         }
+
+         static T min_value(const T* a, std::size_t n)
+         {
+            return *std::min_element(a, a + n);
+         }
+
+         static T max_value(const T* a, std::size_t n)
+         {
+            return *std::max_element(a, a + n);
+         }
+
+         static T dot(const T* a, const T* b, std::size_t n)
+         {
+            return std::inner_product(a, a + n, b, T());
+         }
+      };
+
+   } // end namespace detail
+
    //-------------------------------------------------------------------------------------
-   
-   template <typename T>
+
+   /// @brief Vector whose size is fixed at construction.
+   /// @details A fixed_size_vector<T> is a pointer and a size, and allocates its elements
+   /// with a single allocation. A fixed_size_vector<T, N> stores up to N elements inline,
+   /// so that small vectors do not allocate at all. A moved-from fixed_size_vector is empty.
+   ///
+   /// Heap storage for arithmetic T is padded for the kernels in simd.hpp, and by default
+   /// aligned for them. For the types these kernels support, fixed_size_vector offers
+   /// vectorized element-wise arithmetic, comparisons and reductions.
+   ///
+   /// Copies use the allocator's select_on_container_copy_construction, and assignment keeps
+   /// the allocator of the assigned-to vector, copying the elements if the allocators differ.
+
+   template <typename T, std::size_t N = 0, typename Allocator = detail::default_allocator<T>>
    class fixed_size_vector
    {
    public:
-      
+
       using value_t = T;
-      
-      using vector_t = std::vector<value_t>;
-      
+
+      using value_type = T;
+
+      using allocator_type = Allocator;
+
+      using iterator = value_t*;
+
+      using const_iterator = const value_t*;
+
       /// @brief Constructor
-      
-      explicit fixed_size_vector(std::size_t size, const value_t& value=value_t())
-      : m_vector(size, value)
+
+      explicit fixed_size_vector(std::size_t size,
+                                 const value_t& value=value_t(),
+                                 const Allocator& allocator=Allocator())
+      : m_storage(allocator)
       , m_size(size)
       {
+         m_storage.allocate(m_size);
+         try
+         {
+            std::uninitialized_fill_n(data(), m_size, value);
+         }
+         catch (...)
+         {
+            m_storage.deallocate(m_size);
+            throw;
+         }
+      }
+
+      fixed_size_vector(const fixed_size_vector& other)
+      : fixed_size_vector(other,
+                          std::allocator_traits<Allocator>::select_on_container_copy_construction(
+                             other.get_allocator()))
+      {
+      }
+
+      fixed_size_vector(const fixed_size_vector& other, const Allocator& allocator)
+      : m_storage(allocator)
+      , m_size(other.m_size)
+      {
+         m_storage.allocate(m_size);
+         try
+         {
+            std::uninitialized_copy(other.cbegin(), other.cend(), data());
+         }
+         catch (...)
+         {
+            m_storage.deallocate(m_size);
+            throw;
+         }
       }
-      
+
+      fixed_size_vector(fixed_size_vector&& other)
+      : m_storage(other.get_allocator())
+      , m_size(0)
+      {
+         move_from(other);
+      }
+
+      ~fixed_size_vector()
+      {
+         clear();
+      }
+
+      fixed_size_vector& operator=(const fixed_size_vector& other)
+      {
+         if (this != &other)
+         {
+            fixed_size_vector copy(other, get_allocator());
+            clear();
+            move_from(copy);
+         }
+         return *this;
+      }
+
+      fixed_size_vector& operator=(fixed_size_vector&& other)
+      {
+         if (this != &other)
+         {
+            if (!(get_allocator() == other.get_allocator()))
+            {
+               return *this = static_cast<const fixed_size_vector&>(other);
+            }
+            clear();
+            move_from(other);
+         }
+         return *this;
+      }
+
       /// @brief Read-only subscript operator.
-      
-      const value_t& operator[](int index) const
+
+      const value_t& operator[](std::size_t index) const
       {
-         return m_vector[index];
+         return data()[index];
       }
-      
+
       /// @brief Subscript operator.
-      
-      value_t& operator[](int index)
+
+      value_t& operator[](std::size_t index)
       {
-         return m_vector[index];
+         return data()[index];
       }
-      
+
+      allocator_type get_allocator() const
+      {
+         return m_storage.get_allocator();
+      }
+
       /// @brief Returns the (constant) size of this fixed-size vector.
-      
+
       std::size_t size() const
       {
          return m_size;
       }
-      
-      typename vector_t::iterator begin()
+
+      /// @brief Returns a pointer to the contiguous elements of this fixed-size vector.
+
+      value_t* data()
+      {
+         return m_storage.data(m_size);
+      }
+
+      const value_t* data() const
+      {
+         return m_storage.data(m_size);
+      }
+
+      iterator begin()
+      {
+          return data();
+      }
+
+      const_iterator begin() const
+      {
+         return data();
+      }
+
+      const_iterator cbegin() const
+      {
+         return data();
+      }
+
+      iterator end()
+      {
+          return data() + m_size;
+      }
+
+      const_iterator end() const
+      {
+         return data() + m_size;
+      }
+
+      const_iterator cend() const
+      {
+         return data() + m_size;
+      }
+
+      /// @brief Element-wise arithmetic.
+      /// @pre other.size() == size()
+
+      fixed_size_vector& operator+=(const fixed_size_vector& other)
       {
-          return m_vector.begin();
+         detail::element_ops<T>::add(data(), other.data(), data(), m_size);
+         return *this;
       }
-      
-      typename vector_t::const_iterator cbegin() const
+
+      fixed_size_vector& operator-=(const fixed_size_vector& other)
       {
-         return m_vector.cbegin();
+         detail::element_ops<T>::sub(data(), other.data(), data(), m_size);
+         return *this;
       }
-      
-      typename vector_t::iterator end()
+
+      fixed_size_vector& operator*=(const fixed_size_vector& other)
       {
-          return m_vector.end();
+         detail::element_ops<T>::mul(data(), other.data(), data(), m_size);
+         return *this;
       }
-      
-      
-      typename vector_t::const_iterator cend() const
+
+      /// @brief Assigns value to all elements.
+
+      void fill(const value_t& value)
       {
-         return m_vector.cend();
+         detail::element_ops<T>::fill(data(), m_size, value);
       }
-      
+
    private:
-      
-      vector_t m_vector;
-      
+
+      detail::fixed_size_storage<T, N, Allocator> m_storage;
+
       std::size_t m_size;
-      
-      friend std::ostream& operator << <>(std::ostream&, const fixed_size_vector<T>&);
-      
+
+      /// @brief Destroys the elements and releases the storage, leaving this vector empty.
+
+      void clear()
+      {
+         for (value_t& value : *this)
+         {
+            value.~value_t();
+         }
+         m_storage.deallocate(m_size);
+         m_size = 0;
+         m_storage.allocate(0);
+      }
+
+      /// @pre This vector is empty and other has an equal allocator.
+
+      void move_from(fixed_size_vector& other)
+      {
+         if (decltype(m_storage)::owns_heap(other.m_size))
+         {
+            m_storage.take_heap(other.m_storage);
+            m_size = other.m_size;
+            other.m_size = 0;
+            other.m_storage.allocate(0);
+         }
+         else
+         {
+            // Inline elements are moved one by one, after which other is cleared
+            std::uninitialized_copy(std::make_move_iterator(other.begin()),
+                                    std::make_move_iterator(other.end()),
+                                    m_storage.data(other.m_size));
+            m_size = other.m_size;
+            other.clear();
+         }
+      }
+
    }; // end class template fixed_size_vector
-   
+
    //-------------------------------------------------------------------------------------
-   
-   template <typename T>
-   std::ostream& operator << (std::ostream& os, const fixed_size_vector<T>& vector)
+
+   /// @brief Element-wise comparisons, yielding 1 where the comparison holds and 0 elsewhere.
+   /// @pre a.size() == b.size()
+
+   template <typename T, std::size_t N, typename Allocator>
+   fixed_size_vector<std::uint8_t, N> less(const fixed_size_vector<T, N, Allocator>& a,
+                                           const fixed_size_vector<T, N, Allocator>& b)
    {
-      os << vector.m_vector;
-      return os;
+      fixed_size_vector<std::uint8_t, N> result(a.size());
+      detail::element_ops<T>::less(a.data(), b.data(), result.data(), a.size());
+      return result;
    }
-   
+
+   template <typename T, std::size_t N, typename Allocator>
+   fixed_size_vector<std::uint8_t, N> equal(const fixed_size_vector<T, N, Allocator>& a,
+                                            const fixed_size_vector<T, N, Allocator>& b)
+   {
+      fixed_size_vector<std::uint8_t, N> result(a.size());
+      detail::element_ops<T>::equal(a.data(), b.data(), result.data(), a.size());
+      return result;
+   }
+
+   /// @brief Reductions (see utils::simd, and detail::element_ops for other types).
+
+   template <typename T, std::size_t N, typename Allocator>
+   T sum(const fixed_size_vector<T, N, Allocator>& vector)
+   {
+      return detail::element_ops<T>::sum(vector.data(), vector.size());
+   }
+
+   /// @pre vector.size() > 0
+   template <typename T, std::size_t N, typename Allocator>
+   T min_value(const fixed_size_vector<T, N, Allocator>& vector)
+   {
+      return detail::element_ops<T>::min_value(vector.data(), vector.size());
+   }
+
+   /// @pre vector.size() > 0
+   template <typename T, std::size_t N, typename Allocator>
+   T max_value(const fixed_size_vector<T, N, Allocator>& vector)
+   {
+      return detail::element_ops<T>::max_value(vector.data(), vector.size());
+   }
+
+   /// @pre a.size() == b.size()
+   template <typename T, std::size_t N, typename Allocator>
+   T dot(const fixed_size_vector<T, N, Allocator>& a, const fixed_size_vector<T, N, Allocator>& b)
+   {
+      return detail::element_ops<T>::dot(a.data(), b.data(), a.size());
+   }
+
    //-------------------------------------------------------------------------------------
-   
+
+   template <typename T, std::size_t N, typename Allocator>
+   std::ostream& operator << (std::ostream& os, const fixed_size_vector<T, N, Allocator>& vector)
+   {
+      return utils::io::write_container(
+         os, vector, typename utils::io::container_format<std::vector<T>>::type());
+   }
+
+   //-------------------------------------------------------------------------------------
+
 } // end namespace datastructures
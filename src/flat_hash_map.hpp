@@ -0,0 +1,1007 @@
+#pragma once
+
+#include "container_inserter.hpp"
+#include "container_io.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/// @file flat_hash_map.hpp
+/// @brief Open-addressing hash map with SwissTable-style control bytes.
+/// @details The elements are stored in one array of slots, next to an array with a control byte
+/// per slot: 7 bits of the hash of the key in a full slot, or a marker for an empty or a deleted
+/// slot. Lookups probe groups of 16 slots and compare the 16 control bytes of a group with the
+/// hash bits at once (with SSE2), so that keys are compared almost only when they are equal, and
+/// a lookup typically touches the control bytes and the slot it finds. Compared to the nodes of
+/// std::unordered_map, this saves an allocation and a pointer per element.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace datastructures {
+
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, T>>>
+class flat_hash_map;
+
+namespace detail {
+
+using control_t = std::int8_t;
+
+/// @brief Control bytes of slots that are not full. Full slots have the (non-negative) 7 hash
+/// bits, so that a slot is full if its control byte is non-negative. The sentinel marks the end
+/// of the control bytes, for iteration.
+constexpr control_t control_empty = -128;
+constexpr control_t control_deleted = -2;
+constexpr control_t control_sentinel = -1;
+
+constexpr std::size_t group_width = 16;
+
+/// @brief Mixes the bits of hash, as std::hash is the identity for integers, while the slot is
+/// chosen by the high and matched by the low bits: folds the 128-bit product with a large odd
+/// constant.
+inline std::uint64_t mix_hash(const std::size_t hash)
+{
+   constexpr std::uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+#if defined(__SIZEOF_INT128__)
+   const unsigned __int128 product = static_cast<unsigned __int128>(hash) * multiplier;
+   return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#else
+   std::uint64_t mixed = static_cast<std::uint64_t>(hash);
+   mixed = (mixed ^ (mixed >> 33)) * multiplier;
+   return mixed ^ (mixed >> 29);
+#endif
+}
+
+/// @brief Returns the bits that choose the first group to probe, starting with the well-mixed
+/// middle bits of the product (the low bits of a product depend only on the low bits of hash).
+inline std::size_t hash_position(const std::uint64_t mixed)
+{
+   return static_cast<std::size_t>((mixed >> 32) | (mixed << 32));
+}
+
+inline control_t hash_bits(const std::uint64_t mixed)
+{
+   return static_cast<control_t>(mixed & 0x7f);
+}
+
+/// @brief Returns the smallest capacity (a power of two of at least one group) that holds size
+/// elements at the maximum load factor of 7/8.
+inline std::size_t capacity_for(const std::size_t size)
+{
+   std::size_t capacity = group_width;
+   while (capacity - capacity / 8 < size)
+      capacity *= 2;
+   return capacity;
+}
+
+inline std::size_t growth_limit(const std::size_t capacity)
+{
+   return capacity - capacity / 8;
+}
+
+/// @brief The control bytes of a group of slots, matched against a control byte at once. Masks
+/// have bit i set for slot i of the group.
+
+class group
+{
+public:
+   explicit group(const control_t* control)
+#if defined(__SSE2__)
+   : m_control(_mm_loadu_si128(reinterpret_cast<const __m128i*>(control)))
+#else
+   : m_control(control)
+#endif
+   {
+   }
+
+#if defined(__SSE2__)
+   unsigned match(const control_t control) const
+   {
+      return static_cast<unsigned>(
+         _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(control), m_control)));
+   }
+
+   /// @brief Empty and deleted slots are those whose control byte has the sign bit set.
+   unsigned match_empty_or_deleted() const
+   {
+      return static_cast<unsigned>(_mm_movemask_epi8(m_control));
+   }
+#else
+   unsigned match(const control_t control) const
+   {
+      unsigned mask = 0;
+      for (std::size_t i = 0; i < group_width; ++i)
+         mask |= static_cast<unsigned>(m_control[i] == control) << i;
+      return mask;
+   }
+
+   unsigned match_empty_or_deleted() const
+   {
+      unsigned mask = 0;
+      for (std::size_t i = 0; i < group_width; ++i)
+         mask |= static_cast<unsigned>(m_control[i] < 0) << i;
+      return mask;
+   }
+#endif
+
+   unsigned match_empty() const
+   {
+      return match(control_empty);
+   }
+
+private:
+#if defined(__SSE2__)
+   __m128i m_control;
+#else
+   const control_t* m_control;
+#endif
+
+};   // end class group
+
+inline std::size_t lowest_bit(const unsigned mask)
+{
+   return static_cast<std::size_t>(__builtin_ctz(mask));
+}
+
+/// @brief Visits the groups of a table with a power-of-two number of groups in triangular steps
+/// (1, 2, 3, ... groups), which visits every group once.
+
+class probe_sequence
+{
+public:
+   probe_sequence(const std::size_t position, const std::size_t group_mask)
+   : m_group_mask(group_mask)
+   , m_group(position & group_mask)
+   , m_step(0)
+   {
+   }
+
+   /// @brief Returns the index of the first slot of the current group.
+   std::size_t offset() const
+   {
+      return m_group * group_width;
+   }
+
+   void next()
+   {
+      m_group = (m_group + ++m_step) & m_group_mask;
+   }
+
+private:
+   std::size_t m_group_mask;
+
+   std::size_t m_group;
+
+   std::size_t m_step;
+
+};   // end class probe_sequence
+
+/// @brief Control bytes of tables without slots, so that empty tables need no allocation.
+inline const control_t* empty_control()
+{
+   static const control_t control[1] = {control_sentinel};
+   return control;
+}
+
+/// @brief Forward iterator over the full slots of a flat_hash_map.
+
+template <typename Value, bool Const>
+class flat_hash_map_iterator
+{
+public:
+   using iterator_category = std::forward_iterator_tag;
+   using value_type = Value;
+   using difference_type = std::ptrdiff_t;
+   using reference = typename std::conditional<Const, const Value&, Value&>::type;
+   using pointer = typename std::conditional<Const, const Value*, Value*>::type;
+
+   flat_hash_map_iterator()
+   : m_control(nullptr)
+   , m_slot(nullptr)
+   {
+   }
+
+   flat_hash_map_iterator(const control_t* control, pointer slot)
+   : m_control(control)
+   , m_slot(slot)
+   {
+   }
+
+   /// @brief Conversion of iterator to const_iterator.
+   template <bool OtherConst, typename = typename std::enable_if<Const && !OtherConst>::type>
+   flat_hash_map_iterator(const flat_hash_map_iterator<Value, OtherConst>& other)
+   : m_control(other.m_control)
+   , m_slot(other.m_slot)
+   {
+   }
+
+   reference operator*() const
+   {
+      return *m_slot;
+   }
+
+   pointer operator->() const
+   {
+      return m_slot;
+   }
+
+   flat_hash_map_iterator& operator++()
+   {
+      ++m_control;
+      ++m_slot;
+      skip_free_slots();
+      return *this;
+   }
+
+   flat_hash_map_iterator operator++(int)
+   {
+      flat_hash_map_iterator previous = *this;
+      ++*this;
+      return previous;
+   }
+
+   friend bool operator==(const flat_hash_map_iterator& lhs, const flat_hash_map_iterator& rhs)
+   {
+      return lhs.m_control == rhs.m_control;
+   }
+
+   friend bool operator!=(const flat_hash_map_iterator& lhs, const flat_hash_map_iterator& rhs)
+   {
+      return lhs.m_control != rhs.m_control;
+   }
+
+   /// @brief Advances to the first full slot, or to the sentinel.
+   void skip_free_slots()
+   {
+      while (*m_control < control_sentinel)
+      {
+         ++m_control;
+         ++m_slot;
+      }
+   }
+
+private:
+   template <typename, bool>
+   friend class flat_hash_map_iterator;
+
+   template <typename, typename, typename, typename, typename>
+   friend class datastructures::flat_hash_map;
+
+   const control_t* m_control;
+
+   pointer m_slot;
+
+};   // end class template flat_hash_map_iterator
+
+}   // end namespace detail
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Hash map with the interface of std::unordered_map (without node handles), storing its
+/// elements in an open-addressing table.
+/// @details Unlike with std::unordered_map, inserting may move elements and then invalidates
+/// iterators and references. The buckets of the bucket interface are the slots of the table,
+/// which hold at most one element. The maximum load factor is fixed at 7/8. Assignment replaces
+/// the allocator along with the elements.
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+class flat_hash_map
+{
+public:
+   using key_type = Key;
+   using mapped_type = T;
+   using value_type = std::pair<const Key, T>;
+   using size_type = std::size_t;
+   using difference_type = std::ptrdiff_t;
+   using hasher = Hash;
+   using key_equal = KeyEqual;
+   using allocator_type = Allocator;
+   using reference = value_type&;
+   using const_reference = const value_type&;
+   using pointer = value_type*;
+   using const_pointer = const value_type*;
+   using iterator = detail::flat_hash_map_iterator<value_type, false>;
+   using const_iterator = detail::flat_hash_map_iterator<value_type, true>;
+   using local_iterator = value_type*;
+   using const_local_iterator = const value_type*;
+
+   flat_hash_map()
+   : flat_hash_map(0)
+   {
+   }
+
+   explicit flat_hash_map(const size_type bucket_count,
+                          const hasher& hash = hasher(),
+                          const key_equal& equal = key_equal(),
+                          const allocator_type& allocator = allocator_type())
+   : m_hash(hash)
+   , m_equal(equal)
+   , m_allocator(allocator)
+   , m_control(const_cast<detail::control_t*>(detail::empty_control()))
+   , m_slots(nullptr)
+   , m_capacity(0)
+   , m_size(0)
+   , m_growth_left(0)
+   {
+      if (bucket_count != 0)
+         rehash(bucket_count);
+   }
+
+   explicit flat_hash_map(const allocator_type& allocator)
+   : flat_hash_map(0, hasher(), key_equal(), allocator)
+   {
+   }
+
+   template <typename InputIt>
+   flat_hash_map(InputIt first,
+                 InputIt last,
+                 const size_type bucket_count = 0,
+                 const hasher& hash = hasher(),
+                 const key_equal& equal = key_equal(),
+                 const allocator_type& allocator = allocator_type())
+   : flat_hash_map(bucket_count, hash, equal, allocator)
+   {
+      insert(first, last);
+   }
+
+   flat_hash_map(std::initializer_list<value_type> values,
+                 const size_type bucket_count = 0,
+                 const hasher& hash = hasher(),
+                 const key_equal& equal = key_equal(),
+                 const allocator_type& allocator = allocator_type())
+   : flat_hash_map(values.begin(), values.end(), bucket_count, hash, equal, allocator)
+   {
+   }
+
+   /// @brief Copies the table as is, without rehashing.
+   flat_hash_map(const flat_hash_map& other)
+   : flat_hash_map(0, other.m_hash, other.m_equal,
+                   std::allocator_traits<allocator_type>::select_on_container_copy_construction(
+                      other.m_allocator))
+   {
+      copy_table(other);
+   }
+
+   flat_hash_map(flat_hash_map&& other) noexcept
+   : flat_hash_map(0, other.m_hash, other.m_equal, other.m_allocator)
+   {
+      swap_table(other);
+   }
+
+   ~flat_hash_map()
+   {
+      destroy_table();
+   }
+
+   flat_hash_map& operator=(flat_hash_map other)
+   {
+      swap(other);
+      return *this;
+   }
+
+   flat_hash_map& operator=(std::initializer_list<value_type> values)
+   {
+      clear();
+      insert(values);
+      return *this;
+   }
+
+   allocator_type get_allocator() const
+   {
+      return m_allocator;
+   }
+
+   hasher hash_function() const
+   {
+      return m_hash;
+   }
+
+   key_equal key_eq() const
+   {
+      return m_equal;
+   }
+
+   //-----------------------------------------------------------------------------------------------
+
+   iterator begin()
+   {
+      iterator first(m_control, m_slots);
+      first.skip_free_slots();
+      return first;
+   }
+
+   const_iterator begin() const
+   {
+      const_iterator first(m_control, m_slots);
+      first.skip_free_slots();
+      return first;
+   }
+
+   const_iterator cbegin() const
+   {
+      return begin();
+   }
+
+   iterator end()
+   {
+      return iterator(m_control + m_capacity, m_slots + m_capacity);
+   }
+
+   const_iterator end() const
+   {
+      return const_iterator(m_control + m_capacity, m_slots + m_capacity);
+   }
+
+   const_iterator cend() const
+   {
+      return end();
+   }
+
+   bool empty() const
+   {
+      return m_size == 0;
+   }
+
+   size_type size() const
+   {
+      return m_size;
+   }
+
+   size_type max_size() const
+   {
+      return std::allocator_traits<allocator_type>::max_size(m_allocator);
+   }
+
+   //-----------------------------------------------------------------------------------------------
+
+   /// @brief Destroys all elements, but keeps the capacity.
+   void clear()
+   {
+      destroy_elements();
+      if (m_capacity != 0)
+         std::memset(m_control, detail::control_empty, m_capacity);
+      m_size = 0;
+      m_growth_left = detail::growth_limit(m_capacity);
+   }
+
+   std::pair<iterator, bool> insert(const value_type& value)
+   {
+      return try_emplace(value.first, value.second);
+   }
+
+   std::pair<iterator, bool> insert(value_type&& value)
+   {
+      return try_emplace(value.first, std::move(value.second));
+   }
+
+   template <typename P, typename = typename std::enable_if<
+                            std::is_constructible<value_type, P&&>::value>::type>
+   std::pair<iterator, bool> insert(P&& value)
+   {
+      return emplace(std::forward<P>(value));
+   }
+
+   template <typename InputIt>
+   void insert(InputIt first, const InputIt last)
+   {
+      reserve_for(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+      for (; first != last; ++first)
+         emplace(*first);
+   }
+
+   void insert(std::initializer_list<value_type> values)
+   {
+      insert(values.begin(), values.end());
+   }
+
+   /// @brief Inserts value_type(args...) if its key is not in the map.
+   /// @details The key is needed to find the slot, so the element is first constructed outside
+   /// the table, as a pair of non-const key and value, and then moved into its slot.
+   template <typename... Args>
+   std::pair<iterator, bool> emplace(Args&&... args)
+   {
+      std::pair<key_type, mapped_type> value(std::forward<Args>(args)...);
+      return try_emplace(std::move(value.first), std::move(value.second));
+   }
+
+   template <typename... Args>
+   std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
+   {
+      return emplace_key(key, std::forward<Args>(args)...);
+   }
+
+   template <typename... Args>
+   std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+   {
+      return emplace_key(std::move(key), std::forward<Args>(args)...);
+   }
+
+   mapped_type& operator[](const key_type& key)
+   {
+      return try_emplace(key).first->second;
+   }
+
+   mapped_type& operator[](key_type&& key)
+   {
+      return try_emplace(std::move(key)).first->second;
+   }
+
+   mapped_type& at(const key_type& key)
+   {
+      const std::size_t slot = find_slot(key);
+      if (slot == m_capacity)
+         throw std::out_of_range("flat_hash_map::at: key not found");
+      return m_slots[slot].second;
+   }
+
+   const mapped_type& at(const key_type& key) const
+   {
+      const std::size_t slot = find_slot(key);
+      if (slot == m_capacity)
+         throw std::out_of_range("flat_hash_map::at: key not found");
+      return m_slots[slot].second;
+   }
+
+   /// @brief Erases the element at position and returns the iterator following it. Does not
+   /// move other elements.
+   iterator erase(const_iterator position)
+   {
+      const std::size_t slot = static_cast<std::size_t>(position.m_control - m_control);
+      erase_slot(slot);
+      iterator next(m_control + slot, m_slots + slot);
+      next.skip_free_slots();
+      return next;
+   }
+
+   iterator erase(iterator position)
+   {
+      return erase(const_iterator(position));
+   }
+
+   iterator erase(const_iterator first, const const_iterator last)
+   {
+      while (first != last)
+         first = erase(first);
+      return iterator(m_control + (last.m_control - m_control),
+                      m_slots + (last.m_control - m_control));
+   }
+
+   size_type erase(const key_type& key)
+   {
+      const std::size_t slot = find_slot(key);
+      if (slot == m_capacity)
+         return 0;
+      erase_slot(slot);
+      return 1;
+   }
+
+   void swap(flat_hash_map& other) noexcept
+   {
+      using std::swap;
+      swap(m_hash, other.m_hash);
+      swap(m_equal, other.m_equal);
+      swap(m_allocator, other.m_allocator);
+      swap_table(other);
+   }
+
+   //-----------------------------------------------------------------------------------------------
+
+   iterator find(const key_type& key)
+   {
+      const std::size_t slot = find_slot(key);
+      return iterator(m_control + slot, m_slots + slot);
+   }
+
+   const_iterator find(const key_type& key) const
+   {
+      const std::size_t slot = find_slot(key);
+      return const_iterator(m_control + slot, m_slots + slot);
+   }
+
+   size_type count(const key_type& key) const
+   {
+      return find_slot(key) != m_capacity ? 1 : 0;
+   }
+
+   //-----------------------------------------------------------------------------------------------
+
+   size_type bucket_count() const
+   {
+      return m_capacity;
+   }
+
+   /// @brief The elements of bucket (slot) n: one if the slot is full, none otherwise.
+   local_iterator begin(const size_type n)
+   {
+      return m_slots + n;
+   }
+
+   const_local_iterator begin(const size_type n) const
+   {
+      return m_slots + n;
+   }
+
+   local_iterator end(const size_type n)
+   {
+      return m_slots + n + (m_control[n] >= 0 ? 1 : 0);
+   }
+
+   const_local_iterator end(const size_type n) const
+   {
+      return m_slots + n + (m_control[n] >= 0 ? 1 : 0);
+   }
+
+   float load_factor() const
+   {
+      return m_capacity == 0 ? 0.0f : static_cast<float>(m_size) / static_cast<float>(m_capacity);
+   }
+
+   float max_load_factor() const
+   {
+      return 0.875f;
+   }
+
+   /// @brief Rehashes to at least bucket_count slots, and at least the number of slots needed
+   /// for size() elements.
+   void rehash(const size_type bucket_count)
+   {
+      const std::size_t capacity =
+         std::max(detail::capacity_for(m_size),
+                  bucket_count == 0 ? std::size_t(0) : detail::capacity_for(bucket_count * 7 / 8));
+      if (capacity != m_capacity)
+         resize(capacity);
+   }
+
+   /// @brief Makes room for count elements without rehashing.
+   void reserve(const size_type count)
+   {
+      if (count > m_size + m_growth_left)
+         resize(detail::capacity_for(count));
+   }
+
+private:
+   using control_allocator_type = typename std::allocator_traits<
+      allocator_type>::template rebind_alloc<detail::control_t>;
+
+   /// @brief Whether elements are moved to a new table, or copied because moving could throw.
+   using nothrow_relocatable = std::integral_constant<
+      bool, std::is_nothrow_move_constructible<key_type>::value &&
+               std::is_nothrow_move_constructible<mapped_type>::value>;
+
+   hasher m_hash;
+
+   key_equal m_equal;
+
+   allocator_type m_allocator;
+
+   /// @brief m_capacity control bytes followed by a sentinel.
+   detail::control_t* m_control;
+
+   value_type* m_slots;
+
+   std::size_t m_capacity;
+
+   std::size_t m_size;
+
+   /// @brief Number of empty slots that can be filled before the table grows, such that probing
+   /// always reaches an empty slot.
+   std::size_t m_growth_left;
+
+   std::uint64_t mixed_hash(const key_type& key) const
+   {
+      return detail::mix_hash(m_hash(key));
+   }
+
+   detail::probe_sequence probe_for(const std::uint64_t hash) const
+   {
+      return detail::probe_sequence(detail::hash_position(hash),
+                                    m_capacity / detail::group_width - 1);
+   }
+
+   /// @brief Returns the slot of key, or m_capacity if it is not in the map.
+   std::size_t find_slot(const key_type& key) const
+   {
+      return m_capacity == 0 ? 0 : find_slot(key, mixed_hash(key));
+   }
+
+   std::size_t find_slot(const key_type& key, const std::uint64_t hash) const
+   {
+      const detail::control_t bits = detail::hash_bits(hash);
+      for (detail::probe_sequence probe = probe_for(hash);; probe.next())
+      {
+         const detail::group group(m_control + probe.offset());
+         for (unsigned mask = group.match(bits); mask != 0; mask &= mask - 1)
+         {
+            const std::size_t slot = probe.offset() + detail::lowest_bit(mask);
+            if (m_equal(m_slots[slot].first, key))
+               return slot;
+         }
+         if (group.match_empty() != 0)
+            return m_capacity;
+      }
+   }
+
+   /// @brief Returns the first empty or deleted slot on the probe sequence of hash.
+   std::size_t find_free_slot(const std::uint64_t hash) const
+   {
+      for (detail::probe_sequence probe = probe_for(hash);; probe.next())
+      {
+         const unsigned mask = detail::group(m_control + probe.offset()).match_empty_or_deleted();
+         if (mask != 0)
+            return probe.offset() + detail::lowest_bit(mask);
+      }
+   }
+
+   template <typename K, typename... Args>
+   std::pair<iterator, bool> emplace_key(K&& key, Args&&... args)
+   {
+      const std::uint64_t hash = mixed_hash(key);
+      if (m_capacity != 0)
+      {
+         const std::size_t slot = find_slot(key, hash);
+         if (slot != m_capacity)
+            return {iterator(m_control + slot, m_slots + slot), false};
+      }
+      std::size_t slot = m_capacity == 0 ? 0 : find_free_slot(hash);
+      if (m_capacity == 0 || (m_growth_left == 0 && m_control[slot] != detail::control_deleted))
+      {
+         grow();
+         slot = find_free_slot(hash);
+      }
+      std::allocator_traits<allocator_type>::construct(
+         m_allocator, m_slots + slot, std::piecewise_construct,
+         std::forward_as_tuple(std::forward<K>(key)),
+         std::forward_as_tuple(std::forward<Args>(args)...));
+      if (m_control[slot] == detail::control_empty)
+         --m_growth_left;
+      m_control[slot] = detail::hash_bits(hash);
+      ++m_size;
+      return {iterator(m_control + slot, m_slots + slot), true};
+   }
+
+   /// @brief Doubles the capacity, or rehashes at the same capacity if deleted slots take up
+   /// much of the table.
+   void grow()
+   {
+      if (m_capacity != 0 && m_size <= detail::growth_limit(m_capacity) / 2)
+         resize(m_capacity);
+      else
+         resize(m_capacity == 0 ? detail::group_width : 2 * m_capacity);
+   }
+
+   /// @brief A slot becomes empty if its group has an empty slot, as then no probe sequence
+   /// passed the group when it was full. Otherwise it is marked deleted, so that lookups
+   /// continue past it.
+   void erase_slot(const std::size_t slot)
+   {
+      std::allocator_traits<allocator_type>::destroy(m_allocator, m_slots + slot);
+      const std::size_t offset = slot / detail::group_width * detail::group_width;
+      if (detail::group(m_control + offset).match_empty() != 0)
+      {
+         m_control[slot] = detail::control_empty;
+         ++m_growth_left;
+      }
+      else
+      {
+         m_control[slot] = detail::control_deleted;
+      }
+      --m_size;
+   }
+
+   /// @brief Moves the elements into a new table with capacity slots. Strong exception
+   /// guarantee: if an element is copied rather than moved and the copy throws, the map is
+   /// unchanged.
+   void resize(const std::size_t capacity)
+   {
+      flat_hash_map table(0, m_hash, m_equal, m_allocator);
+      table.allocate_table(capacity);
+      for (std::size_t slot = 0; slot < m_capacity; ++slot)
+      {
+         if (m_control[slot] < 0)
+            continue;
+         const std::uint64_t hash = mixed_hash(m_slots[slot].first);
+         const std::size_t target = table.find_free_slot(hash);
+         relocate(table.m_slots + target, m_slots[slot], nothrow_relocatable{});
+         table.m_control[target] = detail::hash_bits(hash);
+         ++table.m_size;
+         --table.m_growth_left;
+      }
+      swap_table(table);
+   }
+
+   /// @brief Moves the key out of its const pair, which is destroyed right after.
+   void relocate(value_type* target, value_type& source, std::true_type /* nothrow */)
+   {
+      std::allocator_traits<allocator_type>::construct(
+         m_allocator, target, std::piecewise_construct,
+         std::forward_as_tuple(std::move(const_cast<key_type&>(source.first))),
+         std::forward_as_tuple(std::move(source.second)));
+   }
+
+   void relocate(value_type* target, const value_type& source, std::false_type /* nothrow */)
+   {
+      std::allocator_traits<allocator_type>::construct(m_allocator, target, source);
+   }
+
+   void copy_table(const flat_hash_map& other)
+   {
+      if (other.m_size == 0)
+         return;
+      allocate_table(other.m_capacity);
+      for (std::size_t slot = 0; slot < m_capacity; ++slot)
+      {
+         if (other.m_control[slot] < 0)
+            continue;
+         std::allocator_traits<allocator_type>::construct(m_allocator, m_slots + slot,
+                                                          other.m_slots[slot]);
+         m_control[slot] = other.m_control[slot];
+         ++m_size;
+      }
+      std::memcpy(m_control, other.m_control, m_capacity);
+      m_growth_left = other.m_growth_left;
+   }
+
+   /// @brief Allocates capacity empty slots. The table must have no slots.
+   void allocate_table(const std::size_t capacity)
+   {
+      control_allocator_type control_allocator(m_allocator);
+      detail::control_t* const control =
+         std::allocator_traits<control_allocator_type>::allocate(control_allocator, capacity + 1);
+      try
+      {
+         m_slots = std::allocator_traits<allocator_type>::allocate(m_allocator, capacity);
+      }
+      catch (...)
+      {
+         std::allocator_traits<control_allocator_type>::deallocate(control_allocator, control,
+                                                                    capacity + 1);
+         throw;
+      }
+      m_control = control;
+      std::memset(m_control, detail::control_empty, capacity);
+      m_control[capacity] = detail::control_sentinel;
+      m_capacity = capacity;
+      m_growth_left = detail::growth_limit(capacity);
+   }
+
+   void destroy_elements()
+   {
+      for (std::size_t slot = 0; slot < m_capacity; ++slot)
+      {
+         if (m_control[slot] >= 0)
+            std::allocator_traits<allocator_type>::destroy(m_allocator, m_slots + slot);
+      }
+   }
+
+   void destroy_table()
+   {
+      if (m_capacity == 0)
+         return;
+      destroy_elements();
+      control_allocator_type control_allocator(m_allocator);
+      std::allocator_traits<control_allocator_type>::deallocate(control_allocator, m_control,
+                                                                 m_capacity + 1);
+      std::allocator_traits<allocator_type>::deallocate(m_allocator, m_slots, m_capacity);
+   }
+
+   void swap_table(flat_hash_map& other) noexcept
+   {
+      using std::swap;
+      swap(m_control, other.m_control);
+      swap(m_slots, other.m_slots);
+      swap(m_capacity, other.m_capacity);
+      swap(m_size, other.m_size);
+      swap(m_growth_left, other.m_growth_left);
+   }
+
+   template <typename ForwardIt>
+   void reserve_for(const ForwardIt first, const ForwardIt last, std::forward_iterator_tag)
+   {
+      reserve(m_size + static_cast<std::size_t>(std::distance(first, last)));
+   }
+
+   template <typename InputIt>
+   void reserve_for(const InputIt, const InputIt, std::input_iterator_tag)
+   {
+   }
+
+};   // end class template flat_hash_map
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+bool operator==(const flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& lhs,
+                const flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& rhs)
+{
+   if (lhs.size() != rhs.size())
+      return false;
+   for (const auto& value : lhs)
+   {
+      const auto other = rhs.find(value.first);
+      if (other == rhs.end() || !(other->second == value.second))
+         return false;
+   }
+   return true;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+bool operator!=(const flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& lhs,
+                const flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& rhs)
+{
+   return !(lhs == rhs);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+void swap(flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& lhs,
+          flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& rhs) noexcept
+{
+   lhs.swap(rhs);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Reads and writes a flat_hash_map like a std::unordered_map: {(key1,val1),...}.
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+std::ostream& operator<<(std::ostream& os,
+                         const flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& map)
+{
+   utils::io::container_format<flat_hash_map<Key, T, Hash, KeyEqual, Allocator>> format{};
+   return utils::io::write_container(os, map, format.mFormat);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+std::istream& operator>>(std::istream& is, flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& map)
+{
+   utils::io::container_format<flat_hash_map<Key, T, Hash, KeyEqual, Allocator>> format{};
+   return utils::io::read_container(is, map, format.mFormat);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace datastructures
+
+
+namespace utils {
+namespace io {
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+struct supported_container<datastructures::flat_hash_map<Key, T, Hash, KeyEqual, Allocator>>
+: public std::true_type
+{
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+struct container_format<datastructures::flat_hash_map<Key, T, Hash, KeyEqual, Allocator>>
+: public container_format<std::unordered_map<Key, T, Hash, KeyEqual>>
+{
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+class container_inserter<datastructures::flat_hash_map<Key, T, Hash, KeyEqual, Allocator>>
+: public unordered_container_inserter<
+     datastructures::flat_hash_map<Key, T, Hash, KeyEqual, Allocator>>
+{
+public:
+   using unordered_container_inserter<datastructures::flat_hash_map<
+      Key, T, Hash, KeyEqual, Allocator>>::unordered_container_inserter;
+};
+
+}   // end namespace io
+}   // end namespace utils
@@ -1,49 +1,235 @@
 
 #include "fork.hpp"
 
-#include <signal.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+extern char** environ;
 
 
 namespace utils {
 namespace sys {
 
-void fork_process(const std::string& process, const boost::optional<timeout_t>& timeout)
+//--------------------------------------------------------------------------------------------------
+
+process_status::process_status(const bool signaled, const int code)
+: m_signaled(signaled)
+, m_code(code)
+{
+}
+
+process_status process_status::from_wait_status(const int status)
+{
+   return WIFSIGNALED(status) ? process_status(true, WTERMSIG(status))
+                              : process_status(false, WEXITSTATUS(status));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+int open_pidfd(const pid_t pid)
+{
+#if defined(SYS_pidfd_open)
+   return static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+#else
+   (void)pid;
+   errno = ENOSYS;
+   return -1;
+#endif
+}
+
+timespec time_until(const deadline_t& deadline)
+{
+   const auto remaining = std::max<std::chrono::nanoseconds>(
+      deadline - std::chrono::steady_clock::now(), std::chrono::nanoseconds::zero());
+   const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+   timespec result;
+   result.tv_sec = static_cast<time_t>(seconds.count());
+   result.tv_nsec = static_cast<long>((remaining - seconds).count());
+   return result;
+}
+
+}   // end namespace detail
+
+namespace {
+
+/// @brief Closes a file descriptor at the end of its scope.
+class descriptor_guard
+{
+public:
+   explicit descriptor_guard(const int descriptor)
+   : m_descriptor(descriptor)
+   {
+   }
+
+   descriptor_guard(const descriptor_guard&) = delete;
+
+   ~descriptor_guard()
+   {
+      if (m_descriptor >= 0)
+         ::close(m_descriptor);
+   }
+
+   descriptor_guard& operator=(const descriptor_guard&) = delete;
+
+private:
+   int m_descriptor;
+};
+
+boost::optional<process_status> wait_with_backoff(const pid_t pid,
+                                                  const boost::optional<deadline_t>& deadline)
+{
+   std::chrono::nanoseconds interval = std::chrono::microseconds(50);
+   while (true)
+   {
+      if (const auto status = try_reap_child(pid))
+         return status;
+      timespec sleep;
+      sleep.tv_sec = 0;
+      sleep.tv_nsec = static_cast<long>(interval.count());
+      if (deadline)
+      {
+         if (std::chrono::steady_clock::now() >= *deadline)
+            return boost::none;
+         const timespec remaining = detail::time_until(*deadline);
+         if (remaining.tv_sec == 0 && remaining.tv_nsec < sleep.tv_nsec)
+            sleep = remaining;
+      }
+      ::nanosleep(&sleep, nullptr);
+      interval = std::min<std::chrono::nanoseconds>(2 * interval, std::chrono::milliseconds(1));
+   }
+}
+
+std::vector<char*> to_argv(const std::vector<std::string>& strings)
 {
-   pid_t pid = fork();
-   std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+   std::vector<char*> argv;
+   argv.reserve(strings.size() + 1);
+   for (const std::string& string : strings)
+      argv.push_back(const_cast<char*>(string.c_str()));
+   argv.push_back(nullptr);
+   return argv;
+}
+
+}   // end namespace
+
+//--------------------------------------------------------------------------------------------------
+
+command command::shell(const std::string& process)
+{
+   return command({"/bin/sh", "-c", process});
+}
 
-   // Child process
-   if (pid == 0)
+command::command(std::vector<std::string> argv,
+                 boost::optional<std::vector<std::string>> env,
+                 boost::optional<std::string> cwd)
+: m_argv(std::move(argv))
+, m_env(std::move(env))
+, m_cwd(std::move(cwd))
+{
+}
+
+pid_t start_process(const command& command)
+{
+   const std::vector<char*> argv = to_argv(command.m_argv);
+   std::vector<char*> env;
+   if (command.m_env)
+      env = to_argv(*command.m_env);
+   char* const* const envp = command.m_env ? env.data() : environ;
+
+   posix_spawnattr_t attributes;
+   ::posix_spawnattr_init(&attributes);
+   ::posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+   ::posix_spawnattr_setpgroup(&attributes, 0);
+   posix_spawn_file_actions_t actions;
+   ::posix_spawn_file_actions_init(&actions);
+   int error = 0;
+   if (command.m_cwd)
+      error = ::posix_spawn_file_actions_addchdir_np(&actions, command.m_cwd->c_str());
+   pid_t pid = 0;
+   if (error == 0)
+      error = ::posix_spawnp(&pid, argv[0], &actions, &attributes, argv.data(), envp);
+   ::posix_spawn_file_actions_destroy(&actions);
+   ::posix_spawnattr_destroy(&attributes);
+   if (error != 0)
+      throw std::system_error(error, std::generic_category(), "posix_spawn " + command.m_argv[0]);
+   return pid;
+}
+
+void kill_process(const pid_t pid)
+{
+   ::kill(-pid, SIGKILL);
+   while (::waitpid(pid, nullptr, 0) < 0 && errno == EINTR)
    {
-      setpgid(getpid(), getpid());
-      system(process.c_str());
-      exit(EXIT_SUCCESS);
    }
+}
+
+boost::optional<process_status> try_reap_child(const pid_t pid)
+{
+   int status = 0;
+   pid_t result;
+   while ((result = ::waitpid(pid, &status, WNOHANG)) < 0 && errno == EINTR)
+   {
+   }
+   if (result < 0)
+      throw std::system_error(errno, std::generic_category(), "waitpid");
+   if (result == 0)
+      return boost::none;
+   return process_status::from_wait_status(status);
+}
 
-   // Parent process
-   else
+boost::optional<process_status> wait_for_child(const pid_t pid,
+                                               const boost::optional<deadline_t>& deadline)
+{
+   const int pidfd = detail::open_pidfd(pid);
+   if (pidfd < 0)
+      return wait_with_backoff(pid, deadline);
+   const descriptor_guard guard(pidfd);
+   pollfd descriptor{pidfd, POLLIN, 0};
+   while (true)
    {
-      int status;
-      while (true)
+      timespec timeout;
+      if (deadline)
+         timeout = detail::time_until(*deadline);
+      const int ready = ::ppoll(&descriptor, 1, deadline ? &timeout : nullptr, nullptr);
+      if (ready < 0 && errno != EINTR)
+         throw std::system_error(errno, std::generic_category(), "ppoll");
+      if (ready > 0)
+      {
+         if (const auto status = try_reap_child(pid))
+            return status;
+      }
+      else if (ready == 0)
       {
-         if (const pid_t child_status = waitpid(pid, &status, WNOHANG) == pid && WIFEXITED(status))
-            return;
-            
-         // Check for timeout
-         if (timeout)
-         {
-            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-               std::chrono::system_clock::now() - start);
-            
-            if (elapsed >= *timeout)
-            {
-               kill(-pid, SIGKILL);
-               throw process_timed_out();
-            }
-         }
+         return boost::none;
       }
    }
 }
 
+process_status run_process(const command& command, const boost::optional<timeout_t>& timeout)
+{
+   boost::optional<deadline_t> deadline;
+   if (timeout)
+      deadline = std::chrono::steady_clock::now() + *timeout;
+   const pid_t pid = start_process(command);
+   if (const auto status = wait_for_child(pid, deadline))
+      return *status;
+   kill_process(pid);
+   throw process_timed_out();
+}
+
+process_status fork_process(const std::string& process, const boost::optional<timeout_t>& timeout)
+{
+   return run_process(command::shell(process), timeout);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 }   // end namespace sys
 }   // end namespace utils
@@ -3,10 +3,15 @@
 #include <boost/optional.hpp>
 
 #include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 
 #include <chrono>
-#include <exception>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 //--------------------------------------------------------------------------------------------------
 /// @file fork.hpp
@@ -29,7 +34,122 @@ public:
 
 using timeout_t = std::chrono::milliseconds;
 
-void fork_process(const std::string& process, const boost::optional<timeout_t>& timeout);
+using deadline_t = std::chrono::steady_clock::time_point;
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief How a process ended: it exited with an exit status, or a signal terminated it.
+
+class process_status
+{
+public:
+   /// @brief Decodes a status reported by waitpid for a process that ended.
+   static process_status from_wait_status(int status);
+
+   bool exited() const
+   {
+      return !m_signaled;
+   }
+
+   /// @pre exited()
+   int exit_status() const
+   {
+      return m_code;
+   }
+
+   bool signaled() const
+   {
+      return m_signaled;
+   }
+
+   /// @pre signaled()
+   int signal() const
+   {
+      return m_code;
+   }
+
+   /// @brief Whether the process exited with status 0.
+   bool success() const
+   {
+      return !m_signaled && m_code == 0;
+   }
+
+private:
+   process_status(bool signaled, int code);
+
+   bool m_signaled;
+
+   /// @brief The exit status or the signal number.
+   int m_code;
+
+};   // end class process_status
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief A program to run in a child process: its arguments, and optionally its environment
+/// and working directory.
+
+struct command
+{
+   /// @brief Runs process with /bin/sh -c, for commands that need the shell.
+   static command shell(const std::string& process);
+
+   explicit command(std::vector<std::string> argv,
+                    boost::optional<std::vector<std::string>> env = boost::none,
+                    boost::optional<std::string> cwd = boost::none);
+
+   /// @brief The program and its arguments. The program is searched for in the PATH if it does
+   /// not contain a slash.
+   std::vector<std::string> m_argv;
+
+   /// @brief NAME=value entries replacing the environment, or boost::none to inherit it.
+   boost::optional<std::vector<std::string>> m_env;
+
+   /// @brief Working directory, or boost::none to inherit it.
+   boost::optional<std::string> m_cwd;
+};
+
+/// @brief Starts command in a child process that leads a new process group, and returns its pid.
+/// Throws std::system_error if the program cannot be started.
+/// @details Uses posix_spawn, which creates the child without copying the page tables of the
+/// parent (with glibc, by clone with CLONE_VM and CLONE_VFORK), so starting a child does not
+/// get slower as the parent grows. The process group is set by POSIX_SPAWN_SETPGROUP.
+/// @pre !command.m_argv.empty()
+pid_t start_process(const command& command);
+
+/// @brief Kills the process group of a child started by start_process with SIGKILL, and reaps the
+/// child.
+void kill_process(pid_t pid);
+
+/// @brief Reaps the child process pid if it has ended, without blocking.
+boost::optional<process_status> try_reap_child(pid_t pid);
+
+/// @brief Waits until the child process pid ends, and reaps it, or until deadline passes. Returns
+/// boost::none on timeout, when the child is left running.
+/// @details Blocks in ppoll on a pidfd of the child (Linux 5.3 and later), which becomes readable
+/// when the child ends. Without pidfds, falls back to checking on the child at intervals that
+/// grow from 50 microseconds to a millisecond.
+boost::optional<process_status> wait_for_child(pid_t pid,
+                                               const boost::optional<deadline_t>& deadline);
+
+/// @brief Starts command (see start_process) and waits for it to end. If it runs longer than
+/// timeout, kills its process group and throws process_timed_out.
+process_status run_process(const command& command, const boost::optional<timeout_t>& timeout);
+
+/// @brief Runs process with /bin/sh -c, i.e. run_process(command::shell(process), timeout).
+process_status fork_process(const std::string& process, const boost::optional<timeout_t>& timeout);
+
+//--------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+/// @brief Returns a pidfd for pid, or -1 if the kernel does not support them.
+int open_pidfd(pid_t pid);
+
+/// @brief Returns the time left until deadline, or zero if it has passed, as a timespec for ppoll.
+timespec time_until(const deadline_t& deadline);
+
+}   // end namespace detail
 
 }   // end namespace sys
 }   // end namespace utils
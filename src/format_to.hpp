@@ -0,0 +1,578 @@
+#pragma once
+
+#include "charconv.hpp"
+#include "container_output.hpp"
+
+#include <boost/utility/string_view.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <locale>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+//--------------------------------------------------------------------------------------------------
+/// @file format_to.hpp
+/// @brief Serialization of values and supported containers into character buffers, producing the
+/// same text as operator<< without a formatted stream insertion per element.
+/// @details Arithmetic values, strings, std::pair and supported containers are formatted
+/// directly, numbers with to_chars. Other types are formatted with their operator<<. The text
+/// equals that of operator<< on a stream with default formatting flags, precision and the
+/// classic locale.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace io {
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Growable contiguous character buffer that format_to appends to.
+
+class format_buffer
+{
+public:
+   format_buffer() = default;
+
+   explicit format_buffer(const std::size_t capacity)
+   {
+      m_data.reserve(capacity);
+   }
+
+   void append(const char* data, const std::size_t size)
+   {
+      m_data.append(data, size);
+   }
+
+   void push_back(const char c)
+   {
+      m_data.push_back(c);
+   }
+
+   const char* data() const
+   {
+      return m_data.data();
+   }
+
+   std::size_t size() const
+   {
+      return m_data.size();
+   }
+
+   bool empty() const
+   {
+      return m_data.empty();
+   }
+
+   void clear()
+   {
+      m_data.clear();
+   }
+
+   void reserve(const std::size_t capacity)
+   {
+      m_data.reserve(capacity);
+   }
+
+   boost::string_view view() const
+   {
+      return boost::string_view(m_data.data(), m_data.size());
+   }
+
+   /// @brief Moves the buffered text out, leaving the buffer empty.
+   std::string release()
+   {
+      std::string data;
+      data.swap(m_data);
+      return data;
+   }
+
+   /// @brief Writes the buffered text to os in one block and clears the buffer.
+   void flush_to(std::ostream& os)
+   {
+      os.write(m_data.data(), static_cast<std::streamsize>(m_data.size()));
+      m_data.clear();
+   }
+
+private:
+   std::string m_data;
+
+};   // end class format_buffer
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief String that stores up to N characters inline and only allocates for longer text.
+
+template <std::size_t N>
+class small_string
+{
+public:
+   small_string()
+   : m_size(0)
+   {
+   }
+
+   void append(const char* data, const std::size_t size)
+   {
+      if (m_size + size <= N)
+      {
+         std::copy(data, data + size, m_inline + m_size);
+      }
+      else
+      {
+         if (m_size <= N)
+            m_heap.assign(m_inline, m_size);
+         m_heap.append(data, size);
+      }
+      m_size += size;
+   }
+
+   void push_back(const char c)
+   {
+      append(&c, 1);
+   }
+
+   const char* data() const
+   {
+      return m_size <= N ? m_inline : m_heap.data();
+   }
+
+   std::size_t size() const
+   {
+      return m_size;
+   }
+
+   bool empty() const
+   {
+      return m_size == 0;
+   }
+
+   /// @brief Returns whether the text is stored inline.
+   bool is_inline() const
+   {
+      return m_size <= N;
+   }
+
+   boost::string_view view() const
+   {
+      return boost::string_view(data(), m_size);
+   }
+
+   std::string str() const
+   {
+      return std::string(data(), m_size);
+   }
+
+private:
+   char m_inline[N];
+
+   std::string m_heap;
+
+   std::size_t m_size;
+
+};   // end class template small_string
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Returns whether operator<< on os produces the same text as format_to, i.e. os uses
+/// decimal base, the default floating-point format and precision, none of the showbase,
+/// showpoint, showpos, uppercase and boolalpha flags, no field width, and its locale uses '.' as
+/// decimal point without digit grouping.
+
+inline bool is_default_format_stream(const std::ostream& os)
+{
+   const std::ios_base::fmtflags relevant =
+      std::ios_base::basefield | std::ios_base::floatfield | std::ios_base::showbase |
+      std::ios_base::showpoint | std::ios_base::showpos | std::ios_base::uppercase |
+      std::ios_base::boolalpha;
+   if ((os.flags() & relevant) != std::ios_base::dec || os.precision() != 6 || os.width() != 0)
+      return false;
+   const auto& numpunct = std::use_facet<std::numpunct<char>>(os.getloc());
+   return numpunct.decimal_point() == '.' && numpunct.grouping().empty();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+template <typename OutputIt>
+class iterator_sink
+{
+public:
+   explicit iterator_sink(OutputIt out)
+   : m_out(out)
+   {
+   }
+
+   void write(const char* data, const std::size_t size)
+   {
+      m_out = std::copy(data, data + size, m_out);
+   }
+
+   void put(const char c)
+   {
+      *m_out = c;
+      ++m_out;
+   }
+
+   OutputIt out() const
+   {
+      return m_out;
+   }
+
+private:
+   OutputIt m_out;
+};
+
+template <typename T>
+struct is_buffer : public std::false_type
+{
+};
+
+template <>
+struct is_buffer<format_buffer> : public std::true_type
+{
+};
+
+template <std::size_t N>
+struct is_buffer<small_string<N>> : public std::true_type
+{
+};
+
+/// @brief Appends to a format_buffer or small_string.
+
+template <typename Buffer>
+class buffer_sink
+{
+public:
+   explicit buffer_sink(Buffer& buffer)
+   : m_buffer(buffer)
+   {
+   }
+
+   void write(const char* data, const std::size_t size)
+   {
+      m_buffer.append(data, size);
+   }
+
+   void put(const char c)
+   {
+      m_buffer.push_back(c);
+   }
+
+private:
+   Buffer& m_buffer;
+};
+
+/// @brief Appends to a buffer and writes it to a stream whenever it reaches the block size.
+
+class stream_sink
+{
+public:
+   stream_sink(std::ostream& os, format_buffer& buffer, const std::size_t block_size)
+   : m_os(os)
+   , m_buffer(buffer)
+   , m_block_size(block_size)
+   {
+   }
+
+   void write(const char* data, const std::size_t size)
+   {
+      m_buffer.append(data, size);
+      if (m_buffer.size() >= m_block_size)
+         m_buffer.flush_to(m_os);
+   }
+
+   void put(const char c)
+   {
+      m_buffer.push_back(c);
+      if (m_buffer.size() >= m_block_size)
+         m_buffer.flush_to(m_os);
+   }
+
+private:
+   std::ostream& m_os;
+   format_buffer& m_buffer;
+   const std::size_t m_block_size;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+template <typename T>
+struct is_character
+   : public std::integral_constant<bool, std::is_same<T, char>::value ||
+                                            std::is_same<T, signed char>::value ||
+                                            std::is_same<T, unsigned char>::value>
+{
+};
+
+template <typename T>
+struct is_string : public std::false_type
+{
+};
+
+template <typename Traits, typename Allocator>
+struct is_string<std::basic_string<char, Traits, Allocator>> : public std::true_type
+{
+};
+
+template <>
+struct is_string<boost::string_view> : public std::true_type
+{
+};
+
+/// @brief Whether T is formatted without going through its operator<<.
+
+template <typename T>
+struct has_direct_format
+   : public std::integral_constant<bool, std::is_arithmetic<T>::value || is_string<T>::value ||
+                                            supported_container<T>::value>
+{
+};
+
+template <typename T1, typename T2>
+struct has_direct_format<std::pair<T1, T2>> : public std::true_type
+{
+};
+
+template <typename Format, typename Container>
+struct has_direct_format<formatted<Format, Container>> : public std::true_type
+{
+};
+
+// Pairs and containers format their elements recursively
+template <typename Sink, typename T1, typename T2>
+void format(Sink& sink, const std::pair<T1, T2>& pair, bool size_prefix);
+
+template <typename Sink, typename Container>
+typename std::enable_if<supported_container<Container>::value>::type
+format(Sink& sink, const Container& container, bool size_prefix);
+
+template <typename Sink, typename Format, typename Container>
+void format(Sink& sink, const formatted<Format, Container>& container, bool size_prefix);
+
+template <typename Sink, typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                        !is_character<T>::value>::type
+format(Sink& sink, const T value, bool)
+{
+   char buffer[std::numeric_limits<T>::digits10 + 3];
+   const to_chars_result result = to_chars(buffer, buffer + sizeof(buffer), value);
+   sink.write(buffer, static_cast<std::size_t>(result.ptr - buffer));
+}
+
+template <typename Sink>
+void format(Sink& sink, const bool value, bool)
+{
+   sink.put(value ? '1' : '0');
+}
+
+template <typename Sink, typename T>
+typename std::enable_if<is_character<T>::value>::type format(Sink& sink, const T value, bool)
+{
+   sink.put(static_cast<char>(value));
+}
+
+template <typename Sink, typename T>
+typename std::enable_if<std::is_floating_point<T>::value>::type
+format(Sink& sink, const T value, bool)
+{
+   // Large enough for any value in %.6g, which switches to exponent notation beyond 6 digits
+   char buffer[32];
+   const to_chars_result result =
+      to_chars(buffer, buffer + sizeof(buffer), value, chars_format::general, 6);
+   sink.write(buffer, static_cast<std::size_t>(result.ptr - buffer));
+}
+
+template <typename Sink, typename T>
+typename std::enable_if<is_string<T>::value>::type format(Sink& sink, const T& string, bool)
+{
+   sink.write(string.data(), string.size());
+}
+
+/// @brief Writes value to os with operator<<, starting from the formatting state of a new stream.
+template <typename Sink, typename T>
+void format_streamed(Sink& sink, std::ostringstream& os, const T& value)
+{
+   thread_local const std::ostringstream defaults;
+   os.str(std::string());
+   os.clear();
+   os.copyfmt(defaults);
+   os << value;
+   const std::string text = os.str();
+   sink.write(text.data(), text.size());
+}
+
+/// @brief Formats values without a direct format with their operator<<, through a reused stream
+/// of the calling thread. An operator<< that formats values itself, e.g. of recursive types, gets
+/// a new stream for those, as the reused one is still in use.
+
+template <typename Sink, typename T>
+typename std::enable_if<!has_direct_format<T>::value>::type
+format(Sink& sink, const T& value, bool)
+{
+   thread_local std::ostringstream reused;
+   thread_local bool in_use = false;
+   if (in_use)
+   {
+      std::ostringstream os;
+      format_streamed(sink, os, value);
+      return;
+   }
+   struct use_guard
+   {
+      ~use_guard()
+      {
+         in_use = false;
+      }
+   } guard;
+   in_use = true;
+   format_streamed(sink, reused, value);
+}
+
+template <typename Sink, typename T1, typename T2>
+void format(Sink& sink, const std::pair<T1, T2>& pair, const bool size_prefix)
+{
+   const auto format_values = container_format<std::pair<T1, T2>>{}.mFormat;
+   sink.put(format_values.mLeft);
+   format(sink, pair.first, size_prefix);
+   sink.put(format_values.mDel);
+   format(sink, pair.second, size_prefix);
+   sink.put(format_values.mRight);
+}
+
+/// @brief Formats container in the given format, which is either a container_format_values or a
+/// compile-time format<...>.
+
+template <typename Sink, typename Container, typename Format>
+void format_container(Sink& sink,
+                      const Container& container,
+                      const Format& format_values,
+                      const bool size_prefix)
+{
+   if (size_prefix)
+      format(sink, container_size(container), size_prefix);
+   sink.put(format_values.mLeft);
+   auto it = container.begin();
+   if (it != container.end())
+   {
+      format(sink, *it, size_prefix);
+      for (++it; it != container.end(); ++it)
+      {
+         sink.put(format_values.mDel);
+         format(sink, *it, size_prefix);
+      }
+   }
+   sink.put(format_values.mRight);
+}
+
+template <typename Sink, typename Container>
+typename std::enable_if<supported_container<Container>::value>::type
+format(Sink& sink, const Container& container, const bool size_prefix)
+{
+   format_container(sink, container, container_format<Container>{}.mFormat, size_prefix);
+}
+
+template <typename Sink, typename Format, typename Container>
+void format(Sink& sink, const formatted<Format, Container>& container, const bool size_prefix)
+{
+   format_container(sink, container.mContainer, Format{}, size_prefix);
+}
+
+}   // end namespace detail
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Writes the text operator<< produces for value to out and returns the iterator past the
+/// last character written. With size_prefix, containers are written as after the size_prefix
+/// manipulator.
+
+template <typename OutputIt, typename T>
+typename std::enable_if<!detail::is_buffer<typename std::decay<OutputIt>::type>::value,
+                        OutputIt>::type
+format_to(OutputIt out, const T& value, const bool size_prefix = false)
+{
+   detail::iterator_sink<OutputIt> sink(out);
+   detail::format(sink, value, size_prefix);
+   return sink.out();
+}
+
+/// @brief Appends the text operator<< produces for value to buffer.
+
+template <typename T>
+void format_to(format_buffer& buffer, const T& value, const bool size_prefix = false)
+{
+   detail::buffer_sink<format_buffer> sink(buffer);
+   detail::format(sink, value, size_prefix);
+}
+
+/// @brief Appends the text operator<< produces for value to string.
+
+template <std::size_t N, typename T>
+void format_to(small_string<N>& string, const T& value, const bool size_prefix = false)
+{
+   detail::buffer_sink<small_string<N>> sink(string);
+   detail::format(sink, value, size_prefix);
+}
+
+/// @brief Returns the text operator<< produces for value, stored inline if it has at most N
+/// characters.
+
+template <std::size_t N = 32, typename T>
+small_string<N> to_small_string(const T& value)
+{
+   small_string<N> string;
+   format_to(string, value);
+   return string;
+}
+
+/// @brief Returns the text operator<< produces for value, in a buffer of the calling thread that
+/// is reused by subsequent calls. The view is valid until the next call on the same thread.
+/// @details Once the buffer has grown to fit the longest text formatted, calls do not allocate.
+
+template <typename T>
+boost::string_view to_string_view(const T& value)
+{
+   thread_local format_buffer buffer;
+   buffer.clear();
+   format_to(buffer, value);
+   return buffer.view();
+}
+
+/// @brief Default size of the blocks write_formatted writes to a stream.
+constexpr std::size_t format_block_size = 1 << 16;
+
+/// @brief Writes value to os like operator<<, honoring the size_prefix manipulator.
+/// @details If os has the default formatting state (see is_default_format_stream), value is
+/// formatted into a buffer that is written to os in blocks of block_size characters. Otherwise
+/// value is written with operator<<.
+
+template <typename T>
+std::ostream& write_formatted(std::ostream& os,
+                              const T& value,
+                              const std::size_t block_size = format_block_size)
+{
+   if (!is_default_format_stream(os))
+      return os << value;
+   const std::ostream::sentry ok(os);
+   if (ok)
+   {
+      format_buffer buffer(block_size);
+      detail::stream_sink sink(os, buffer, block_size);
+      detail::format(sink, value, os.iword(size_prefix_index()) != 0);
+      buffer.flush_to(os);
+   }
+   return os;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace io
+}   // end namespace utils
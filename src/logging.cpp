@@ -0,0 +1,281 @@
+
+#include "logging.hpp"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace utils {
+namespace logging {
+
+//--------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+std::atomic<unsigned> g_enabled_modules(~0u);
+
+namespace {
+
+/// @brief Single-producer single-consumer ring buffer of the records of one thread. The logging
+/// thread appends records, the thread holding the logger's mutex consumes them.
+
+struct ring
+{
+   explicit ring(const unsigned thread)
+   : m_head(0)
+   , m_tail(0)
+   , m_orphaned(false)
+   , m_thread(thread)
+   {
+   }
+
+   bool push(const record& rec)
+   {
+      const std::size_t head = m_head.load(std::memory_order_relaxed);
+      if (head - m_tail.load(std::memory_order_acquire) == ring_capacity)
+         return false;
+      record& slot = m_records[head % ring_capacity];
+      slot.m_level = rec.m_level;
+      slot.m_module = rec.m_module;
+      slot.m_thread = m_thread;
+      slot.m_length = rec.m_length;
+      std::memcpy(slot.m_message, rec.m_message, rec.m_length);
+      m_head.store(head + 1, std::memory_order_release);
+      return true;
+   }
+
+   template <typename Function>
+   void consume(Function&& function)
+   {
+      const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+      const std::size_t head = m_head.load(std::memory_order_acquire);
+      for (std::size_t pos = tail; pos != head; ++pos)
+         function(m_records[pos % ring_capacity]);
+      m_tail.store(head, std::memory_order_release);
+   }
+
+   std::array<record, ring_capacity> m_records;
+
+   std::atomic<std::size_t> m_head;
+
+   std::atomic<std::size_t> m_tail;
+
+   /// @brief Set when the owning thread exits, after which the ring is removed once drained.
+   std::atomic<bool> m_orphaned;
+
+   const unsigned m_thread;
+};
+
+class logger
+{
+public:
+   static logger& instance()
+   {
+      static logger the_logger;
+      return the_logger;
+   }
+
+   logger(const logger&) = delete;
+
+   ~logger()
+   {
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_stop = true;
+      }
+      m_wakeup.notify_one();
+      if (m_flusher.joinable())
+         m_flusher.join();
+      flush();
+   }
+
+   logger& operator=(const logger&) = delete;
+
+   std::shared_ptr<ring> register_thread()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_rings.push_back(std::make_shared<ring>(m_next_thread++));
+      if (!m_flusher.joinable())
+         m_flusher = std::thread(&logger::run_flusher, this);
+      return m_rings.back();
+   }
+
+   void count_dropped()
+   {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   std::size_t dropped() const
+   {
+      return m_dropped.load(std::memory_order_relaxed);
+   }
+
+   void set_output(std::ostream& os)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      drain();
+      m_output = &os;
+   }
+
+   void flush()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      drain();
+   }
+
+private:
+   logger()
+   : m_output(&std::clog)
+   , m_next_thread(0)
+   , m_dropped(0)
+   , m_stop(false)
+   {
+   }
+
+   std::mutex m_mutex;
+
+   std::condition_variable m_wakeup;
+
+   std::ostream* m_output;
+
+   std::vector<std::shared_ptr<ring>> m_rings;
+
+   unsigned m_next_thread;
+
+   std::atomic<std::size_t> m_dropped;
+
+   bool m_stop;
+
+   std::thread m_flusher;
+
+   /// @pre m_mutex is held.
+   void drain()
+   {
+      std::ostream& os = *m_output;
+      bool written = false;
+      for (auto it = m_rings.begin(); it != m_rings.end();)
+      {
+         // Records pushed before the owner exited are visible once the orphaned flag is
+         const bool orphaned = (*it)->m_orphaned.load(std::memory_order_acquire);
+         (*it)->consume([&os, &written](const record& rec) {
+            os << '[' << to_string(rec.m_level) << "] [" << module_name(rec.m_module)
+               << "] [thread " << rec.m_thread << "] ";
+            os.write(rec.m_message, rec.m_length);
+            os << '\n';
+            written = true;
+         });
+         it = orphaned ? m_rings.erase(it) : it + 1;
+      }
+      if (written)
+         os.flush();
+   }
+
+   void run_flusher()
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (!m_stop)
+      {
+         m_wakeup.wait_for(lock, std::chrono::milliseconds(flush_interval_ms));
+         drain();
+      }
+   }
+};
+
+struct thread_ring
+{
+   ~thread_ring()
+   {
+      if (m_ring)
+         m_ring->m_orphaned.store(true, std::memory_order_release);
+   }
+
+   std::shared_ptr<ring> m_ring;
+};
+
+thread_local thread_ring t_ring;
+
+}   // end namespace
+
+void commit(const record& rec)
+{
+   logger& the_logger = logger::instance();
+   if (!t_ring.m_ring)
+      t_ring.m_ring = the_logger.register_thread();
+   if (!t_ring.m_ring->push(rec))
+      the_logger.count_dropped();
+}
+
+}   // end namespace detail
+
+//--------------------------------------------------------------------------------------------------
+
+const char* to_string(const level lvl)
+{
+   switch (lvl)
+   {
+      case level::trace:
+         return "trace";
+      case level::debug:
+         return "debug";
+      case level::info:
+         return "info";
+      case level::warning:
+         return "warning";
+      case level::error:
+         return "error";
+   }
+   return "unknown";
+}
+
+const char* module_name(const unsigned mod)
+{
+   switch (mod)
+   {
+      case module::general:
+         return "general";
+      case module::io:
+         return "io";
+      case module::threads:
+         return "threads";
+      case module::process:
+         return "process";
+   }
+   return "unknown";
+}
+
+unsigned enabled_modules()
+{
+   return detail::g_enabled_modules.load(std::memory_order_relaxed);
+}
+
+void set_enabled_modules(const unsigned mask)
+{
+   detail::g_enabled_modules.store(mask, std::memory_order_relaxed);
+}
+
+void set_output(std::ostream& os)
+{
+   detail::logger::instance().set_output(os);
+}
+
+void flush()
+{
+   detail::logger::instance().flush();
+}
+
+std::size_t dropped_records()
+{
+   return detail::logger::instance().dropped();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace logging
+}   // end namespace utils
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+
+//--------------------------------------------------------------------------------------------------
+/// @file logging.hpp
+/// @brief Logging with compile-time levels and module masks, buffered per thread and written by a
+/// background flusher.
+/// @details Log statements below UTILS_LOG_LEVEL expand to nothing, and statements for modules
+/// outside UTILS_LOG_MODULES are discarded by the optimizer, so that disabled diagnostics cost
+/// nothing. UTILS_LOG_LEVEL defaults to UTILS_LOG_LEVEL_WARNING. Enabled statements format their
+/// message into a record in a lock-free ring buffer owned by the calling thread. A background
+/// thread drains the ring buffers of all threads into the output stream (std::clog by default).
+/// When a ring buffer is full, its records are dropped and counted rather than blocking the
+/// logging thread.
+///
+/// Usage: UTILS_LOG_DEBUG(utils::logging::module::io, "read " << count << " elements");
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+#define UTILS_LOG_LEVEL_TRACE 0
+#define UTILS_LOG_LEVEL_DEBUG 1
+#define UTILS_LOG_LEVEL_INFO 2
+#define UTILS_LOG_LEVEL_WARNING 3
+#define UTILS_LOG_LEVEL_ERROR 4
+#define UTILS_LOG_LEVEL_OFF 5
+
+#ifndef UTILS_LOG_LEVEL
+#   define UTILS_LOG_LEVEL UTILS_LOG_LEVEL_WARNING
+#endif
+
+/// @brief Bitwise or of the utils::logging::module values that are compiled in.
+#ifndef UTILS_LOG_MODULES
+#   define UTILS_LOG_MODULES (~0u)
+#endif
+
+
+namespace utils {
+namespace logging {
+
+//--------------------------------------------------------------------------------------------------
+
+enum class level : std::uint8_t
+{
+   trace = UTILS_LOG_LEVEL_TRACE,
+   debug = UTILS_LOG_LEVEL_DEBUG,
+   info = UTILS_LOG_LEVEL_INFO,
+   warning = UTILS_LOG_LEVEL_WARNING,
+   error = UTILS_LOG_LEVEL_ERROR
+};
+
+/// @brief Modules that can be enabled separately, at compile time through UTILS_LOG_MODULES and
+/// at run time through set_enabled_modules.
+
+namespace module {
+
+constexpr unsigned general = 1u << 0;
+constexpr unsigned io = 1u << 1;
+constexpr unsigned threads = 1u << 2;
+constexpr unsigned process = 1u << 3;
+
+}   // end namespace module
+
+const char* to_string(level lvl);
+
+const char* module_name(unsigned mod);
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Maximal length of a message, longer messages are truncated.
+constexpr std::size_t max_message_length = 240;
+
+/// @brief Number of records buffered per thread.
+constexpr std::size_t ring_capacity = 256;
+
+/// @brief Interval at which the background thread writes buffered records.
+constexpr unsigned flush_interval_ms = 50;
+
+struct record
+{
+   level m_level;
+   unsigned m_module;
+   /// @brief Index of the logging thread, in the order in which threads first logged.
+   unsigned m_thread;
+   std::uint16_t m_length;
+   char m_message[max_message_length];
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Returns the modules enabled at run time (all by default).
+unsigned enabled_modules();
+
+void set_enabled_modules(unsigned mask);
+
+/// @brief Sets the stream records are written to. The stream must outlive all logging, or be
+/// replaced before it is destroyed.
+void set_output(std::ostream& os);
+
+/// @brief Writes all records buffered so far by any thread to the output and flushes it.
+void flush();
+
+/// @brief Returns the number of records dropped because a ring buffer was full.
+std::size_t dropped_records();
+
+//--------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+extern std::atomic<unsigned> g_enabled_modules;
+
+constexpr bool compiled_in(const unsigned mod)
+{
+   return (mod & UTILS_LOG_MODULES) != 0;
+}
+
+inline bool enabled(const unsigned mod)
+{
+   return (g_enabled_modules.load(std::memory_order_relaxed) & mod) != 0;
+}
+
+/// @brief Streambuf writing into a fixed-size character array, discarding what does not fit.
+
+class array_streambuf : public std::streambuf
+{
+public:
+   void reset(char* first, const std::size_t size)
+   {
+      setp(first, first + size);
+   }
+
+   std::size_t length() const
+   {
+      return static_cast<std::size_t>(pptr() - pbase());
+   }
+
+protected:
+   int_type overflow(const int_type ch) override
+   {
+      return traits_type::not_eof(ch);
+   }
+};
+
+/// @brief Appends a record to the calling thread's ring buffer, or counts it as dropped if the
+/// ring buffer is full.
+void commit(const record& rec);
+
+/// @brief Formats one message into a record and commits it on destruction.
+
+class record_builder
+{
+public:
+   record_builder(const level lvl, const unsigned mod)
+   : m_stream(&m_buffer)
+   {
+      m_record.m_level = lvl;
+      m_record.m_module = mod;
+      m_buffer.reset(m_record.m_message, max_message_length);
+   }
+
+   record_builder(const record_builder&) = delete;
+
+   ~record_builder()
+   {
+      m_record.m_length = static_cast<std::uint16_t>(m_buffer.length());
+      commit(m_record);
+   }
+
+   record_builder& operator=(const record_builder&) = delete;
+
+   std::ostream& stream()
+   {
+      return m_stream;
+   }
+
+private:
+   record m_record;
+
+   array_streambuf m_buffer;
+
+   std::ostream m_stream;
+};
+
+}   // end namespace detail
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace logging
+}   // end namespace utils
+
+
+#define UTILS_LOG_IMPL(lvl, mod, x)                                                                \
+   do                                                                                              \
+   {                                                                                               \
+      if (::utils::logging::detail::compiled_in(mod) && ::utils::logging::detail::enabled(mod))    \
+      {                                                                                            \
+         ::utils::logging::detail::record_builder utils_log_record(lvl, mod);                      \
+         utils_log_record.stream() << x;                                                           \
+      }                                                                                            \
+   } while (false)
+
+#define UTILS_LOG_DISABLED(mod, x)                                                                 \
+   do                                                                                              \
+   {                                                                                               \
+   } while (false)
+
+#if UTILS_LOG_LEVEL <= UTILS_LOG_LEVEL_TRACE
+#   define UTILS_LOG_TRACE(mod, x) UTILS_LOG_IMPL(::utils::logging::level::trace, mod, x)
+#else
+#   define UTILS_LOG_TRACE(mod, x) UTILS_LOG_DISABLED(mod, x)
+#endif
+
+#if UTILS_LOG_LEVEL <= UTILS_LOG_LEVEL_DEBUG
+#   define UTILS_LOG_DEBUG(mod, x) UTILS_LOG_IMPL(::utils::logging::level::debug, mod, x)
+#else
+#   define UTILS_LOG_DEBUG(mod, x) UTILS_LOG_DISABLED(mod, x)
+#endif
+
+#if UTILS_LOG_LEVEL <= UTILS_LOG_LEVEL_INFO
+#   define UTILS_LOG_INFO(mod, x) UTILS_LOG_IMPL(::utils::logging::level::info, mod, x)
+#else
+#   define UTILS_LOG_INFO(mod, x) UTILS_LOG_DISABLED(mod, x)
+#endif
+
+#if UTILS_LOG_LEVEL <= UTILS_LOG_LEVEL_WARNING
+#   define UTILS_LOG_WARNING(mod, x) UTILS_LOG_IMPL(::utils::logging::level::warning, mod, x)
+#else
+#   define UTILS_LOG_WARNING(mod, x) UTILS_LOG_DISABLED(mod, x)
+#endif
+
+#if UTILS_LOG_LEVEL <= UTILS_LOG_LEVEL_ERROR
+#   define UTILS_LOG_ERROR(mod, x) UTILS_LOG_IMPL(::utils::logging::level::error, mod, x)
+#else
+#   define UTILS_LOG_ERROR(mod, x) UTILS_LOG_DISABLED(mod, x)
+#endif
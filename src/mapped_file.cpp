@@ -0,0 +1,89 @@
+
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace utils {
+namespace io {
+
+mapped_file::mapped_file(const std::string& filename)
+: m_data(nullptr)
+, m_size(0)
+, m_open(false)
+{
+   const int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+   if (fd == -1)
+      return;
+
+   struct stat status;
+   if (fstat(fd, &status) == 0)
+   {
+      m_size = static_cast<std::size_t>(status.st_size);
+      if (m_size == 0)
+      {
+         m_open = true;
+      }
+      else
+      {
+         void* const data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+         if (data != MAP_FAILED)
+         {
+            // Files are parsed front to back
+            madvise(data, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const char*>(data);
+            m_open = true;
+         }
+         else
+         {
+            m_size = 0;
+         }
+      }
+   }
+   close(fd);
+}
+
+mapped_file::mapped_file(mapped_file&& other)
+: m_data(other.m_data)
+, m_size(other.m_size)
+, m_open(other.m_open)
+{
+   other.m_data = nullptr;
+   other.m_size = 0;
+   other.m_open = false;
+}
+
+mapped_file::~mapped_file()
+{
+   unmap();
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other)
+{
+   if (this != &other)
+   {
+      unmap();
+      m_data = other.m_data;
+      m_size = other.m_size;
+      m_open = other.m_open;
+      other.m_data = nullptr;
+      other.m_size = 0;
+      other.m_open = false;
+   }
+   return *this;
+}
+
+void mapped_file::unmap()
+{
+   if (m_data != nullptr)
+      munmap(const_cast<char*>(m_data), m_size);
+   m_data = nullptr;
+   m_size = 0;
+   m_open = false;
+}
+
+}   // end namespace io
+}   // end namespace utils
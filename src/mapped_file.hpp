@@ -0,0 +1,87 @@
+#pragma once
+
+#include <boost/utility/string_view.hpp>
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+
+//--------------------------------------------------------------------------------------------------
+/// @file mapped_file.hpp
+/// @brief Read-only memory mapping of a file and a streambuf reading from memory.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace io {
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Maps a file read-only into memory for the lifetime of the object.
+/// @details Like std::ifstream, construction does not throw: whether mapping the file succeeded is
+/// reported by is_open(). An empty file is open with a null data pointer.
+
+class mapped_file
+{
+public:
+   explicit mapped_file(const std::string& filename);
+
+   mapped_file(const mapped_file&) = delete;
+   mapped_file(mapped_file&& other);
+   ~mapped_file();
+
+   mapped_file& operator=(const mapped_file&) = delete;
+   mapped_file& operator=(mapped_file&& other);
+
+   bool is_open() const
+   {
+      return m_open;
+   }
+
+   const char* data() const
+   {
+      return m_data;
+   }
+
+   std::size_t size() const
+   {
+      return m_size;
+   }
+
+   boost::string_view view() const
+   {
+      return boost::string_view(m_data, m_size);
+   }
+
+private:
+   const char* m_data;
+
+   std::size_t m_size;
+
+   bool m_open;
+
+   void unmap();
+
+};   // end class mapped_file
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief A read-only streambuf over a range of characters in memory, which it does not copy.
+
+class memory_streambuf : public std::streambuf
+{
+public:
+   explicit memory_streambuf(const boost::string_view& text)
+   {
+      char* const first = const_cast<char*>(text.data());
+      setg(first, first, first + text.size());
+   }
+
+};   // end class memory_streambuf
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace io
+}   // end namespace utils
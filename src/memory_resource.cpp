@@ -0,0 +1,207 @@
+
+#include "memory_resource.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+
+namespace utils {
+namespace memory {
+
+//--------------------------------------------------------------------------------------------------
+
+namespace {
+
+class new_delete_memory_resource : public memory_resource
+{
+private:
+   /// @details operator new only guarantees alignof(std::max_align_t), so over-aligned
+   /// allocations are made with posix_memalign and released with free.
+   void* do_allocate(const std::size_t bytes, const std::size_t alignment) override
+   {
+      if (alignment <= alignof(std::max_align_t))
+         return ::operator new(bytes);
+      void* memory = nullptr;
+      if (::posix_memalign(&memory, alignment, std::max<std::size_t>(bytes, 1)) != 0)
+         throw std::bad_alloc();
+      return memory;
+   }
+
+   void do_deallocate(void* memory, std::size_t, const std::size_t alignment) override
+   {
+      if (alignment <= alignof(std::max_align_t))
+         ::operator delete(memory);
+      else
+         std::free(memory);
+   }
+};
+
+thread_local memory_resource* t_current = nullptr;
+
+std::size_t align_up(const std::size_t value, const std::size_t alignment)
+{
+   return (value + alignment - 1) / alignment * alignment;
+}
+
+}   // end namespace
+
+memory_resource& new_delete_resource()
+{
+   static new_delete_memory_resource resource;
+   return resource;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+monotonic_arena::monotonic_arena(const std::size_t initial_chunk_size, memory_resource& upstream)
+: m_upstream(upstream)
+, m_initial_chunk_size(std::max<std::size_t>(initial_chunk_size, 64))
+, m_chunks(nullptr)
+, m_position(nullptr)
+, m_end(nullptr)
+, m_next_chunk_size(m_initial_chunk_size)
+, m_allocated(0)
+{
+}
+
+monotonic_arena::~monotonic_arena()
+{
+   release();
+}
+
+void monotonic_arena::release()
+{
+   while (m_chunks != nullptr)
+   {
+      chunk* const next = m_chunks->m_next;
+      m_upstream.deallocate(m_chunks, m_chunks->m_size);
+      m_chunks = next;
+   }
+   m_position = nullptr;
+   m_end = nullptr;
+   m_next_chunk_size = m_initial_chunk_size;
+   m_allocated = 0;
+}
+
+void* monotonic_arena::do_allocate(const std::size_t bytes, const std::size_t alignment)
+{
+   const auto aligned = [alignment](char* position) {
+      return reinterpret_cast<char*>(
+         align_up(reinterpret_cast<std::uintptr_t>(position), alignment));
+   };
+   char* first = aligned(m_position);
+   if (m_position == nullptr || bytes > static_cast<std::size_t>(m_end - first))
+   {
+      const std::size_t header = align_up(sizeof(chunk), alignof(std::max_align_t));
+      const std::size_t size = std::max(m_next_chunk_size, header + bytes + alignment);
+      chunk* const new_chunk = static_cast<chunk*>(m_upstream.allocate(size));
+      new_chunk->m_next = m_chunks;
+      new_chunk->m_size = size;
+      m_chunks = new_chunk;
+      m_position = reinterpret_cast<char*>(new_chunk) + header;
+      m_end = reinterpret_cast<char*>(new_chunk) + size;
+      m_next_chunk_size = 2 * m_next_chunk_size;
+      first = aligned(m_position);
+   }
+   m_position = first + bytes;
+   m_allocated += bytes;
+   return first;
+}
+
+void monotonic_arena::do_deallocate(void*, std::size_t, std::size_t)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+block_pool::block_pool(const std::size_t block_size,
+                       const std::size_t blocks_per_chunk,
+                       memory_resource& upstream)
+: m_upstream(upstream)
+, m_block_size(align_up(std::max(block_size, sizeof(free_block)), alignof(std::max_align_t)))
+, m_blocks_per_chunk(std::max<std::size_t>(blocks_per_chunk, 1))
+, m_chunks(nullptr)
+, m_free(nullptr)
+{
+}
+
+block_pool::~block_pool()
+{
+   release();
+}
+
+void block_pool::release()
+{
+   const std::size_t chunk_size =
+      align_up(sizeof(chunk), alignof(std::max_align_t)) + m_blocks_per_chunk * m_block_size;
+   while (m_chunks != nullptr)
+   {
+      chunk* const next = m_chunks->m_next;
+      m_upstream.deallocate(m_chunks, chunk_size);
+      m_chunks = next;
+   }
+   m_free = nullptr;
+}
+
+void* block_pool::do_allocate(const std::size_t bytes, const std::size_t alignment)
+{
+   if (bytes > m_block_size || alignment > alignof(std::max_align_t))
+      return m_upstream.allocate(bytes, alignment);
+   if (m_free == nullptr)
+   {
+      // Carve a new chunk into blocks and put them on the free list in address order
+      const std::size_t header = align_up(sizeof(chunk), alignof(std::max_align_t));
+      char* const memory =
+         static_cast<char*>(m_upstream.allocate(header + m_blocks_per_chunk * m_block_size));
+      chunk* const new_chunk = reinterpret_cast<chunk*>(memory);
+      new_chunk->m_next = m_chunks;
+      m_chunks = new_chunk;
+      for (std::size_t i = m_blocks_per_chunk; i-- > 0;)
+      {
+         free_block* const block = reinterpret_cast<free_block*>(memory + header + i * m_block_size);
+         block->m_next = m_free;
+         m_free = block;
+      }
+   }
+   free_block* const block = m_free;
+   m_free = block->m_next;
+   return block;
+}
+
+void block_pool::do_deallocate(void* memory, const std::size_t bytes, const std::size_t alignment)
+{
+   if (bytes > m_block_size || alignment > alignof(std::max_align_t))
+   {
+      m_upstream.deallocate(memory, bytes, alignment);
+      return;
+   }
+   free_block* const block = static_cast<free_block*>(memory);
+   block->m_next = m_free;
+   m_free = block;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+memory_resource& current_resource()
+{
+   return t_current != nullptr ? *t_current : new_delete_resource();
+}
+
+resource_scope::resource_scope(memory_resource& resource)
+: m_previous(t_current)
+{
+   t_current = &resource;
+}
+
+resource_scope::~resource_scope()
+{
+   t_current = m_previous;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace memory
+}   // end namespace utils
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//--------------------------------------------------------------------------------------------------
+/// @file memory_resource.hpp
+/// @brief Arena and pool memory resources and an allocator that draws from them.
+/// @details A resource_allocator allocates from a memory_resource. A default-constructed
+/// resource_allocator uses the resource of the innermost resource_scope on the calling thread, so
+/// that containers which the container readers default-construct for nested values allocate from
+/// the same resource as the outer container. An arena_snapshot holds a value whose memory all
+/// comes from an arena it owns, such that the value can be discarded at once.
+///
+/// Like std::pmr (which this follows, for C++14), the resources are not thread-safe.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace memory {
+
+//--------------------------------------------------------------------------------------------------
+
+class memory_resource
+{
+public:
+   virtual ~memory_resource() = default;
+
+   void* allocate(const std::size_t bytes, const std::size_t alignment = alignof(std::max_align_t))
+   {
+      return do_allocate(bytes, alignment);
+   }
+
+   void deallocate(void* memory, const std::size_t bytes,
+                   const std::size_t alignment = alignof(std::max_align_t))
+   {
+      do_deallocate(memory, bytes, alignment);
+   }
+
+private:
+   virtual void* do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+   virtual void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) = 0;
+
+};   // end class memory_resource
+
+/// @brief Returns the resource that uses the global operator new and operator delete.
+memory_resource& new_delete_resource();
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Hands out memory from large chunks by bumping a pointer. Deallocation does nothing; all
+/// memory is freed at once by release or the destructor.
+
+class monotonic_arena : public memory_resource
+{
+public:
+   explicit monotonic_arena(std::size_t initial_chunk_size = 4096,
+                            memory_resource& upstream = new_delete_resource());
+
+   monotonic_arena(const monotonic_arena&) = delete;
+   ~monotonic_arena() override;
+
+   monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+   /// @brief Frees all memory allocated from the arena. Objects in it are not destroyed.
+   void release();
+
+   /// @brief Returns the number of bytes allocated from the arena since the last release.
+   std::size_t allocated_bytes() const
+   {
+      return m_allocated;
+   }
+
+private:
+   struct chunk
+   {
+      chunk* m_next;
+      std::size_t m_size;
+   };
+
+   memory_resource& m_upstream;
+
+   const std::size_t m_initial_chunk_size;
+
+   /// @brief Chunks allocated from upstream, most recent first.
+   chunk* m_chunks;
+
+   char* m_position;
+
+   char* m_end;
+
+   /// @brief Size of the next chunk, which doubles with every chunk.
+   std::size_t m_next_chunk_size;
+
+   std::size_t m_allocated;
+
+   void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+   void do_deallocate(void*, std::size_t, std::size_t) override;
+
+};   // end class monotonic_arena
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Pool of fixed-size blocks, carved out of chunks and recycled through a free list.
+/// @details Suits node-based containers (std::list, std::map, ...), whose allocations are all
+/// nodes of one size. Allocations larger than the block size go to the upstream resource.
+
+class block_pool : public memory_resource
+{
+public:
+   explicit block_pool(std::size_t block_size, std::size_t blocks_per_chunk = 256,
+                       memory_resource& upstream = new_delete_resource());
+
+   block_pool(const block_pool&) = delete;
+   ~block_pool() override;
+
+   block_pool& operator=(const block_pool&) = delete;
+
+   std::size_t block_size() const
+   {
+      return m_block_size;
+   }
+
+   /// @brief Frees all chunks of the pool. Blocks in use become invalid.
+   void release();
+
+private:
+   struct free_block
+   {
+      free_block* m_next;
+   };
+
+   struct chunk
+   {
+      chunk* m_next;
+   };
+
+   memory_resource& m_upstream;
+
+   const std::size_t m_block_size;
+
+   const std::size_t m_blocks_per_chunk;
+
+   chunk* m_chunks;
+
+   free_block* m_free;
+
+   void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+   void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) override;
+
+};   // end class block_pool
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Returns the resource of the innermost resource_scope on the calling thread, or
+/// new_delete_resource() outside any scope.
+memory_resource& current_resource();
+
+/// @brief Makes resource the current resource of the calling thread during its lifetime.
+
+class resource_scope
+{
+public:
+   explicit resource_scope(memory_resource& resource);
+
+   resource_scope(const resource_scope&) = delete;
+   ~resource_scope();
+
+   resource_scope& operator=(const resource_scope&) = delete;
+
+private:
+   memory_resource* m_previous;
+
+};   // end class resource_scope
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Allocator that allocates from a memory_resource.
+/// @details Like std::pmr::polymorphic_allocator, the resource does not propagate on container
+/// assignment or swap, and copies of a container use the current resource.
+
+template <typename T>
+class resource_allocator
+{
+public:
+   using value_type = T;
+
+   resource_allocator() noexcept
+   : m_resource(&current_resource())
+   {
+   }
+
+   resource_allocator(memory_resource& resource) noexcept
+   : m_resource(&resource)
+   {
+   }
+
+   template <typename U>
+   resource_allocator(const resource_allocator<U>& other) noexcept
+   : m_resource(other.resource())
+   {
+   }
+
+   T* allocate(const std::size_t n)
+   {
+      if (n > static_cast<std::size_t>(-1) / sizeof(T))
+         throw std::bad_alloc();
+      return static_cast<T*>(m_resource->allocate(n * sizeof(T), alignof(T)));
+   }
+
+   void deallocate(T* memory, const std::size_t n)
+   {
+      m_resource->deallocate(memory, n * sizeof(T), alignof(T));
+   }
+
+   resource_allocator select_on_container_copy_construction() const
+   {
+      return resource_allocator();
+   }
+
+   memory_resource* resource() const
+   {
+      return m_resource;
+   }
+
+private:
+   memory_resource* m_resource;
+
+};   // end class template resource_allocator
+
+template <typename T, typename U>
+bool operator==(const resource_allocator<T>& lhs, const resource_allocator<U>& rhs)
+{
+   return lhs.resource() == rhs.resource();
+}
+
+template <typename T, typename U>
+bool operator!=(const resource_allocator<T>& lhs, const resource_allocator<U>& rhs)
+{
+   return !(lhs == rhs);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template <typename Allocator>
+struct is_resource_allocator : public std::false_type
+{
+};
+
+template <typename T>
+struct is_resource_allocator<resource_allocator<T>> : public std::true_type
+{
+};
+
+namespace detail {
+
+template <typename... Ts>
+struct make_void
+{
+   using type = void;
+};
+
+}   // end namespace detail
+
+/// @brief Whether the memory of a T can be freed without destroying it: T is trivially
+/// destructible, or a pair of such types, or a container whose allocator is a
+/// resource_allocator and whose elements can be freed without destroying them.
+
+template <typename T, typename = void>
+struct is_releasable : public std::is_trivially_destructible<T>
+{
+};
+
+template <typename T>
+struct is_releasable<
+   T, typename detail::make_void<typename T::allocator_type, typename T::value_type>::type>
+: public std::integral_constant<
+     bool, is_resource_allocator<typename T::allocator_type>::value &&
+              is_releasable<typename std::remove_const<typename T::value_type>::type>::value>
+{
+};
+
+template <typename T1, typename T2>
+struct is_releasable<std::pair<T1, T2>>
+: public std::integral_constant<bool, is_releasable<typename std::remove_const<T1>::type>::value &&
+                                         is_releasable<T2>::value>
+{
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief A value of type T allocated, together with all memory it allocates through
+/// default-constructed resource_allocators, in an arena the snapshot owns.
+/// @details Discarding the value (reset or destruction) frees the arena at once. If T is
+/// releasable, the value is not even destroyed, which makes discarding it independent of its
+/// size; otherwise its destructor runs first, whose deallocations in the arena cost nothing.
+
+template <typename T>
+class arena_snapshot
+{
+public:
+   explicit arena_snapshot(const std::size_t initial_chunk_size = 4096)
+   : m_arena(initial_chunk_size)
+   , m_value(nullptr)
+   {
+      construct();
+   }
+
+   arena_snapshot(const arena_snapshot&) = delete;
+
+   ~arena_snapshot()
+   {
+      destroy();
+   }
+
+   arena_snapshot& operator=(const arena_snapshot&) = delete;
+
+   T& value()
+   {
+      return *m_value;
+   }
+
+   const T& value() const
+   {
+      return *m_value;
+   }
+
+   monotonic_arena& arena()
+   {
+      return m_arena;
+   }
+
+   /// @brief Discards the value and replaces it with a default-constructed one. If constructing
+   /// the new value throws, the snapshot holds no value until the next successful reset.
+   void reset()
+   {
+      destroy();
+      m_arena.release();
+      construct();
+   }
+
+private:
+   monotonic_arena m_arena;
+
+   T* m_value;
+
+   void construct()
+   {
+      const resource_scope scope(m_arena);
+      m_value = new (m_arena.allocate(sizeof(T), alignof(T))) T();
+   }
+
+   void destroy()
+   {
+      if (m_value == nullptr)
+         return;
+      destroy(is_releasable<T>{});
+      m_value = nullptr;
+   }
+
+   void destroy(std::true_type /* releasable */)
+   {
+   }
+
+   void destroy(std::false_type /* releasable */)
+   {
+      m_value->~T();
+   }
+
+};   // end class template arena_snapshot
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace memory
+}   // end namespace utils
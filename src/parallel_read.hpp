@@ -0,0 +1,239 @@
+#pragma once
+
+#include "container_scanner.hpp"
+#include "mapped_file.hpp"
+#include "utils_io.hpp"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//--------------------------------------------------------------------------------------------------
+/// @file parallel_read.hpp
+/// @brief Multi-threaded reading of one large serialized container, splitting its text at the
+/// delimiters between top-level elements.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace io {
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief The text of numbers consists of digits, signs, '.' and exponents, so that it does not
+/// contain any delimiters. The text of other values (e.g. strings and characters) can contain any
+/// character, so that the delimiters between them cannot be found without parsing them.
+
+template <typename T>
+struct is_splittable_value
+   : public std::integral_constant<bool, is_scannable_value<T>::value &&
+                                            std::is_arithmetic<T>::value &&
+                                            (sizeof(T) != 1 || std::is_same<T, bool>::value)>
+{
+};
+
+/// @brief The text of pairs of splittable values is enclosed in the pair's brackets.
+
+template <typename T1, typename T2>
+struct is_splittable_value<std::pair<T1, T2>>
+   : public std::integral_constant<bool, is_splittable_value<T1>::value &&
+                                            is_splittable_value<T2>::value>
+{
+};
+
+//--------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+enum class split_char
+{
+   other,
+   left,
+   right,
+   del
+};
+
+using split_table = std::array<split_char, 256>;
+
+template <typename T>
+void add_brackets(split_table&, const T*)
+{
+}
+
+template <typename T1, typename T2>
+void add_brackets(split_table& table, const std::pair<T1, T2>*)
+{
+   const container_format<std::pair<T1, T2>> format{};
+   table[static_cast<unsigned char>(format.mFormat.mLeft)] = split_char::left;
+   table[static_cast<unsigned char>(format.mFormat.mRight)] = split_char::right;
+   add_brackets(table, static_cast<const T1*>(nullptr));
+   add_brackets(table, static_cast<const T2*>(nullptr));
+}
+
+/// @brief Returns the positions of at most count - 1 delimiters between elements of type T in
+/// [first,last), which starts right after the left bracket of a container with the given format,
+/// such that the elements between them have roughly equal text lengths.
+/// @details Scans up to the last split position, keeping track of the nesting depth of the
+/// elements' brackets. Stops early at the container's right bracket.
+
+template <typename T>
+std::vector<const char*> find_splits(const char* first,
+                                     const char* last,
+                                     const container_format_values& format,
+                                     const std::size_t count)
+{
+   split_table table;
+   table.fill(split_char::other);
+   table[static_cast<unsigned char>(format.mDel)] = split_char::del;
+   table[static_cast<unsigned char>(format.mRight)] = split_char::right;
+   add_brackets(table, static_cast<const T*>(nullptr));
+
+   std::vector<const char*> splits;
+   const std::size_t length = static_cast<std::size_t>(last - first);
+   std::size_t depth = 0;
+   for (const char* pos = first; pos != last && splits.size() + 1 < count; ++pos)
+   {
+      switch (table[static_cast<unsigned char>(*pos)])
+      {
+         case split_char::left:
+            ++depth;
+            break;
+         case split_char::right:
+            if (depth == 0)
+               return splits;
+            --depth;
+            break;
+         case split_char::del:
+            if (depth == 0 && pos >= first + length * (splits.size() + 1) / count)
+               splits.push_back(pos);
+            break;
+         case split_char::other:
+            break;
+      }
+   }
+   return splits;
+}
+
+}   // end namespace detail
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Minimal text length per thread for parallel_read_from_memory.
+constexpr std::size_t parallel_read_min_chunk = 1 << 16;
+
+/// @brief Reads a Container from text on up to num_threads threads. Returns whether reading
+/// succeeded.
+/// @details The elements of the container are split at top-level delimiters into chunks of
+/// roughly equal length, which are parsed concurrently into separate buffers. The buffers are
+/// then inserted into container in input order, after reserving it for all elements, so that
+/// the result equals that of read_from_memory. If any chunk cannot be parsed on its own, text is
+/// read again by read_from_memory, which determines the result.
+/// @note Only containers whose elements are splittable values, e.g. numbers and pairs of
+/// numbers, can be read in parallel.
+
+template <typename Container>
+bool parallel_read_from_memory(const boost::string_view& text,
+                               Container& container,
+                               const unsigned int num_threads = std::thread::hardware_concurrency())
+{
+   using T = typename read_value<Container>::type;
+   static_assert(supported_container<Container>::value && is_splittable_value<T>::value,
+                 "parallel_read_from_memory requires a container of splittable values");
+
+   const std::size_t max_chunks = std::max<std::size_t>(
+      1, std::min<std::size_t>(num_threads, text.size() / parallel_read_min_chunk));
+   if (max_chunks == 1)
+      return read_from_memory(text, container);
+
+   const container_format<Container> format{};
+   memory_source prefix_source(text.data(), text.data() + text.size());
+   container_scanner<memory_source> prefix_scanner(prefix_source);
+   std::size_t size = 0;
+   const bool sized = prefix_scanner.read_container_prefix(format.mFormat, size);
+   if (!prefix_scanner.read_left(format.mFormat))
+      return read_from_memory(text, container);
+
+   // [begins[i],begins[i+1]-1) is the text of the i-th chunk, the last chunk extends to the end
+   const char* const first = prefix_source.position();
+   const char* const last = text.data() + text.size();
+   const std::vector<const char*> splits =
+      detail::find_splits<T>(first, last, format.mFormat, max_chunks);
+   if (splits.empty())
+      return read_from_memory(text, container);
+   std::vector<const char*> begins{first};
+   for (const char* split : splits)
+      begins.push_back(split + 1);
+
+   const std::size_t chunks = begins.size();
+   std::vector<std::vector<T>> buffers(chunks);
+   std::vector<char> parsed(chunks, false);
+   std::vector<std::exception_ptr> exceptions(chunks);
+   const auto parse_chunk = [&](const std::size_t index) {
+      try
+      {
+         const bool is_last = index + 1 == chunks;
+         memory_source source(begins[index], is_last ? last : splits[index]);
+         container_scanner<memory_source> scanner(source);
+         std::vector<T>& buffer = buffers[index];
+         const auto insert = [&buffer](T& value) { buffer.push_back(std::move(value)); };
+         parsed[index] = is_last ? scanner.template read_last_elements<T>(format.mFormat, insert)
+                                 : scanner.template read_element_sequence<T>(format.mFormat, insert);
+      }
+      catch (...)
+      {
+         exceptions[index] = std::current_exception();
+      }
+   };
+
+   std::vector<std::thread> threads;
+   for (std::size_t index = 1; index < chunks; ++index)
+      threads.emplace_back(parse_chunk, index);
+   parse_chunk(0);
+   for (std::thread& thread : threads)
+      thread.join();
+   for (const std::exception_ptr& exception : exceptions)
+      if (exception)
+         std::rethrow_exception(exception);
+
+   if (std::find(parsed.begin(), parsed.end(), false) != parsed.end())
+      return read_from_memory(text, container);
+
+   std::size_t count = 0;
+   for (const std::vector<T>& buffer : buffers)
+      count += buffer.size();
+   if (sized && count != size)
+      return false;
+
+   container_inserter<Container> inserter(container);
+   inserter.reserve(count);
+   for (std::vector<T>& buffer : buffers)
+   {
+      for (T& value : buffer)
+         inserter.insert(std::move(value));
+      std::vector<T>().swap(buffer);
+   }
+   return inserter.finish();
+}
+
+/// @brief Maps the given file into memory and reads a Container from it on up to num_threads
+/// threads (see parallel_read_from_memory).
+
+template <typename Container>
+bool parallel_read_from_file(const std::string& filename,
+                             Container& container,
+                             const unsigned int num_threads = std::thread::hardware_concurrency())
+{
+   const mapped_file file(filename);
+   return file.is_open() && parallel_read_from_memory(file.view(), container, num_threads);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace io
+}   // end namespace utils
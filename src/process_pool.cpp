@@ -0,0 +1,176 @@
+
+#include "process_pool.hpp"
+
+#include <poll.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <thread>
+
+
+namespace utils {
+namespace sys {
+namespace {
+
+struct running_job
+{
+   std::size_t m_job;
+
+   pid_t m_pid;
+
+   /// @brief A pidfd for the process, or -1 if the kernel does not support them.
+   int m_pidfd;
+
+   deadline_t m_start;
+
+   boost::optional<deadline_t> m_deadline;
+};
+
+/// @brief Longest wait for children without a pidfd before checking on them.
+constexpr std::chrono::milliseconds fallback_interval(1);
+
+/// @brief The child processes of one batch. Kills those still running on destruction, so that
+/// none outlive a batch that is aborted by an exception.
+class running_jobs
+{
+public:
+   running_jobs() = default;
+
+   running_jobs(const running_jobs&) = delete;
+
+   ~running_jobs()
+   {
+      for (const running_job& job : m_jobs)
+      {
+         kill_process(job.m_pid);
+         close(job);
+      }
+   }
+
+   running_jobs& operator=(const running_jobs&) = delete;
+
+   std::size_t size() const
+   {
+      return m_jobs.size();
+   }
+
+   bool empty() const
+   {
+      return m_jobs.empty();
+   }
+
+   void start(const std::size_t job, const process_job& process)
+   {
+      const deadline_t start = std::chrono::steady_clock::now();
+      boost::optional<deadline_t> deadline;
+      if (process.m_timeout)
+         deadline = start + *process.m_timeout;
+      m_jobs.reserve(m_jobs.size() + 1);
+      const pid_t pid = start_process(process.m_command);
+      m_jobs.push_back({job, pid, detail::open_pidfd(pid), start, deadline});
+   }
+
+   /// @brief Waits until a child may have ended or a deadline has passed.
+   void wait()
+   {
+      boost::optional<deadline_t> deadline;
+      bool polling = false;
+      m_descriptors.clear();
+      for (const running_job& job : m_jobs)
+      {
+         if (job.m_deadline && (!deadline || *job.m_deadline < *deadline))
+            deadline = job.m_deadline;
+         if (job.m_pidfd >= 0)
+            m_descriptors.push_back({job.m_pidfd, POLLIN, 0});
+         else
+            polling = true;
+      }
+      if (polling)
+      {
+         const deadline_t next = std::chrono::steady_clock::now() + fallback_interval;
+         if (!deadline || next < *deadline)
+            deadline = next;
+      }
+      timespec timeout;
+      if (deadline)
+         timeout = detail::time_until(*deadline);
+      if (::ppoll(m_descriptors.data(), m_descriptors.size(), deadline ? &timeout : nullptr,
+                  nullptr) < 0 &&
+          errno != EINTR)
+         throw std::system_error(errno, std::generic_category(), "ppoll");
+   }
+
+   /// @brief Reaps the children that have ended and kills those past their deadline, calling
+   /// done for each.
+   void collect(const process_pool::callback& done)
+   {
+      const deadline_t now = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < m_jobs.size();)
+      {
+         const running_job job = m_jobs[i];
+         boost::optional<process_status> status = try_reap_child(job.m_pid);
+         if (!status && !(job.m_deadline && now >= *job.m_deadline))
+         {
+            ++i;
+            continue;
+         }
+         if (!status)
+            kill_process(job.m_pid);
+         close(job);
+         m_jobs[i] = m_jobs.back();
+         m_jobs.pop_back();
+         done({job.m_job, status, std::chrono::steady_clock::now() - job.m_start});
+      }
+   }
+
+private:
+   std::vector<running_job> m_jobs;
+
+   std::vector<pollfd> m_descriptors;
+
+   static void close(const running_job& job)
+   {
+      if (job.m_pidfd >= 0)
+         ::close(job.m_pidfd);
+   }
+};
+
+}   // end namespace
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t process_pool::default_process_count()
+{
+   return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+process_pool::process_pool(const std::size_t max_processes)
+: m_max_processes(std::max<std::size_t>(max_processes, 1))
+{
+}
+
+void process_pool::run(const std::vector<process_job>& jobs, const callback& done) const
+{
+   running_jobs running;
+   std::size_t next = 0;
+   while (next < jobs.size() || !running.empty())
+   {
+      for (; next < jobs.size() && running.size() < m_max_processes; ++next)
+         running.start(next, jobs[next]);
+      running.wait();
+      running.collect(done);
+   }
+}
+
+std::vector<process_result> process_pool::run(const std::vector<process_job>& jobs) const
+{
+   std::vector<process_result> results(jobs.size());
+   run(jobs, [&results](const process_result& result) { results[result.m_job] = result; });
+   return results;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace sys
+}   // end namespace utils
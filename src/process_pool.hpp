@@ -0,0 +1,85 @@
+#pragma once
+
+#include "fork.hpp"
+
+#include <boost/optional.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+//--------------------------------------------------------------------------------------------------
+/// @file process_pool.hpp
+/// @brief Runs batches of commands in concurrent child processes, each with its own timeout.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace sys {
+
+struct process_job
+{
+   command m_command;
+
+   boost::optional<timeout_t> m_timeout;
+};
+
+struct process_result
+{
+   /// @brief Index of the job in the batch.
+   std::size_t m_job;
+
+   /// @brief How the process ended, or boost::none if it timed out and was killed.
+   boost::optional<process_status> m_status;
+
+   /// @brief Time from starting the process until it ended or was killed.
+   std::chrono::nanoseconds m_duration;
+
+   bool timed_out() const
+   {
+      return !m_status;
+   }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Runs batches of process_jobs, with at most max_processes() of them at a time.
+/// @details A batch is driven by one event loop on the calling thread, not by a thread per child:
+/// it blocks in ppoll on a pidfd of each running child, until a child ends or the earliest
+/// deadline passes. A job that outlives its timeout has its process group killed, like in
+/// run_process. Without pidfds, the running children are checked on every millisecond.
+
+class process_pool
+{
+public:
+   using callback = std::function<void(const process_result&)>;
+
+   /// @brief Returns the hardware concurrency, but at least 1.
+   static std::size_t default_process_count();
+
+   explicit process_pool(std::size_t max_processes = default_process_count());
+
+   std::size_t max_processes() const
+   {
+      return m_max_processes;
+   }
+
+   /// @brief Runs jobs, starting them in order, and calls done with the result of each job as it
+   /// ends, on the calling thread. Returns when all jobs have ended.
+   /// @details If starting a job or done throws, the running jobs are killed and the exception
+   /// is rethrown.
+   void run(const std::vector<process_job>& jobs, const callback& done) const;
+
+   /// @brief Runs jobs and returns their results in the order of jobs.
+   std::vector<process_result> run(const std::vector<process_job>& jobs) const;
+
+private:
+   std::size_t m_max_processes;
+
+};   // end class process_pool
+
+}   // end namespace sys
+}   // end namespace utils
@@ -0,0 +1,810 @@
+
+#include "simd.hpp"
+
+#include <immintrin.h>
+
+#include <atomic>
+
+
+namespace utils {
+namespace simd {
+
+//--------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// @details The kernels process blocks of lanes<T>() elements with loops of constant length,
+/// which the compiler turns into whole-register operations. They are always inlined into the
+/// per-instruction-set entry points below, so that they are compiled once for each target.
+
+#define UTILS_SIMD_INLINE inline __attribute__((always_inline))
+
+struct add_op
+{
+   template <typename T>
+   UTILS_SIMD_INLINE T operator()(const T a, const T b) const
+   {
+      return a + b;
+   }
+};
+
+struct sub_op
+{
+   template <typename T>
+   UTILS_SIMD_INLINE T operator()(const T a, const T b) const
+   {
+      return a - b;
+   }
+};
+
+struct mul_op
+{
+   template <typename T>
+   UTILS_SIMD_INLINE T operator()(const T a, const T b) const
+   {
+      return a * b;
+   }
+};
+
+struct min_op
+{
+   template <typename T>
+   UTILS_SIMD_INLINE T operator()(const T a, const T b) const
+   {
+      return b < a ? b : a;
+   }
+};
+
+struct max_op
+{
+   template <typename T>
+   UTILS_SIMD_INLINE T operator()(const T a, const T b) const
+   {
+      return a < b ? b : a;
+   }
+};
+
+struct less_op
+{
+   template <typename T>
+   UTILS_SIMD_INLINE std::uint8_t operator()(const T a, const T b) const
+   {
+      return a < b;
+   }
+};
+
+struct equal_op
+{
+   template <typename T>
+   UTILS_SIMD_INLINE std::uint8_t operator()(const T a, const T b) const
+   {
+      return a == b;
+   }
+};
+
+template <typename T, typename Out, typename Op>
+UTILS_SIMD_INLINE void transform_kernel(const T* a, const T* b, Out* out, const std::size_t n)
+{
+   constexpr std::size_t block_size = lanes<T>();
+   std::size_t i = 0;
+   for (; i + block_size <= n; i += block_size)
+   {
+      // Computing the block before storing it keeps it vectorizable if out aliases a or b
+      Out block[block_size];
+      for (std::size_t j = 0; j < block_size; ++j)
+         block[j] = Op()(a[i + j], b[i + j]);
+      for (std::size_t j = 0; j < block_size; ++j)
+         out[i + j] = block[j];
+   }
+   for (; i < n; ++i)
+      out[i] = Op()(a[i], b[i]);
+}
+
+template <typename T, typename Op>
+UTILS_SIMD_INLINE T reduce_kernel(const T* a, const std::size_t n, const T init)
+{
+   constexpr std::size_t block_size = lanes<T>();
+   T accumulators[block_size];
+   for (std::size_t j = 0; j < block_size; ++j)
+      accumulators[j] = init;
+   std::size_t i = 0;
+   for (; i + block_size <= n; i += block_size)
+      for (std::size_t j = 0; j < block_size; ++j)
+         accumulators[j] = Op()(accumulators[j], a[i + j]);
+   for (; i < n; ++i)
+      accumulators[0] = Op()(accumulators[0], a[i]);
+   T result = init;
+   for (std::size_t j = 0; j < block_size; ++j)
+      result = Op()(result, accumulators[j]);
+   return result;
+}
+
+template <typename T>
+UTILS_SIMD_INLINE T dot_kernel(const T* a, const T* b, const std::size_t n)
+{
+   constexpr std::size_t block_size = lanes<T>();
+   T accumulators[block_size] = {};
+   std::size_t i = 0;
+   for (; i + block_size <= n; i += block_size)
+      for (std::size_t j = 0; j < block_size; ++j)
+         accumulators[j] += a[i + j] * b[i + j];
+   for (; i < n; ++i)
+      accumulators[0] += a[i] * b[i];
+   T result = T();
+   for (std::size_t j = 0; j < block_size; ++j)
+      result += accumulators[j];
+   return result;
+}
+
+template <typename T>
+UTILS_SIMD_INLINE void fill_kernel(T* out, const std::size_t n, const T value)
+{
+   constexpr std::size_t block_size = lanes<T>();
+   std::size_t i = 0;
+   for (; i + block_size <= n; i += block_size)
+      for (std::size_t j = 0; j < block_size; ++j)
+         out[i + j] = value;
+   for (; i < n; ++i)
+      out[i] = value;
+}
+
+template <typename T>
+UTILS_SIMD_INLINE void copy_kernel(const T* __restrict a, T* __restrict out, const std::size_t n)
+{
+   constexpr std::size_t block_size = lanes<T>();
+   std::size_t i = 0;
+   for (; i + block_size <= n; i += block_size)
+      for (std::size_t j = 0; j < block_size; ++j)
+         out[i + j] = a[i + j];
+   for (; i < n; ++i)
+      out[i] = a[i];
+}
+
+/// @brief Defines a struct of entry points to the kernels that are compiled with the given
+/// function attributes.
+
+#define UTILS_SIMD_TARGET(name, attributes)                                                        \
+   struct name                                                                                     \
+   {                                                                                               \
+      template <typename T, typename Out, typename Op>                                             \
+      attributes static void transform(const T* a, const T* b, Out* out, const std::size_t n)      \
+      {                                                                                            \
+         transform_kernel<T, Out, Op>(a, b, out, n);                                               \
+      }                                                                                            \
+                                                                                                   \
+      template <typename T, typename Op>                                                           \
+      attributes static T reduce(const T* a, const std::size_t n, const T init)                    \
+      {                                                                                            \
+         return reduce_kernel<T, Op>(a, n, init);                                                  \
+      }                                                                                            \
+                                                                                                   \
+      template <typename T>                                                                        \
+      attributes static T dot(const T* a, const T* b, const std::size_t n)                         \
+      {                                                                                            \
+         return dot_kernel(a, b, n);                                                               \
+      }                                                                                            \
+                                                                                                   \
+      template <typename T>                                                                        \
+      attributes static void fill(T* out, const std::size_t n, const T value)                      \
+      {                                                                                            \
+         fill_kernel(out, n, value);                                                               \
+      }                                                                                            \
+                                                                                                   \
+      template <typename T>                                                                        \
+      attributes static void copy(const T* a, T* out, const std::size_t n)                         \
+      {                                                                                            \
+         copy_kernel(a, out, n);                                                                   \
+      }                                                                                            \
+   };
+
+UTILS_SIMD_TARGET(scalar_target, )
+UTILS_SIMD_TARGET(avx2_target, __attribute__((target("avx2"))))
+UTILS_SIMD_TARGET(avx512_target, __attribute__((target("avx512f,avx512bw,avx512dq"))))
+
+#undef UTILS_SIMD_TARGET
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Whether value satisfies the comparison Kind with low and high, evaluated without
+/// branches.
+
+template <comparison Kind>
+using comparison_constant = std::integral_constant<comparison, Kind>;
+
+template <typename T>
+UTILS_SIMD_INLINE bool matches(comparison_constant<comparison::less>, const T value, const T low,
+                               const T)
+{
+   return value < low;
+}
+
+template <typename T>
+UTILS_SIMD_INLINE bool matches(comparison_constant<comparison::equal>, const T value, const T low,
+                               const T)
+{
+   return value == low;
+}
+
+template <typename T>
+UTILS_SIMD_INLINE bool matches(comparison_constant<comparison::in_range>, const T value,
+                               const T low, const T high)
+{
+   return (low <= value) & (value < high);
+}
+
+template <comparison Kind, typename T>
+UTILS_SIMD_INLINE std::size_t select_tail(const T* a, const std::size_t first, const std::size_t n,
+                                          const T low, const T high,
+                                          const std::uint64_t first_index, std::uint64_t* out)
+{
+   std::size_t count = 0;
+   for (std::size_t i = first; i < n; ++i)
+   {
+      out[count] = first_index + i;
+      count += matches(comparison_constant<Kind>(), a[i], low, high);
+   }
+   return count;
+}
+
+template <comparison Kind, typename T>
+UTILS_SIMD_INLINE std::size_t count_tail(const T* a, const std::size_t first, const std::size_t n,
+                                         const T low, const T high)
+{
+   std::size_t count = 0;
+   for (std::size_t i = first; i < n; ++i)
+      count += matches(comparison_constant<Kind>(), a[i], low, high);
+   return count;
+}
+
+/// @brief Calls Target::template select<Kind>(...) for the run-time kind.
+
+#define UTILS_SIMD_SELECT_DISPATCH(function, ...)                                                  \
+   switch (kind)                                                                                   \
+   {                                                                                               \
+      case comparison::less:                                                                       \
+         return function<comparison::less>(__VA_ARGS__);                                           \
+      case comparison::equal:                                                                      \
+         return function<comparison::equal>(__VA_ARGS__);                                          \
+      case comparison::in_range:                                                                   \
+         return function<comparison::in_range>(__VA_ARGS__);                                       \
+   }                                                                                               \
+   return 0;
+
+struct scalar_select
+{
+   template <typename T>
+   static std::size_t select(const T* a, const std::size_t n, const comparison kind, const T low,
+                             const T high, const std::uint64_t first_index, std::uint64_t* out)
+   {
+      UTILS_SIMD_SELECT_DISPATCH(select_tail, a, 0, n, low, high, first_index, out)
+   }
+
+   template <typename T>
+   static std::size_t count(const T* a, const std::size_t n, const comparison kind, const T low,
+                            const T high)
+   {
+      UTILS_SIMD_SELECT_DISPATCH(count_tail, a, 0, n, low, high)
+   }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+#define UTILS_SIMD_AVX2 __attribute__((target("avx2"), always_inline)) inline
+
+/// @brief Comparisons of AVX2 registers of T, yielding one mask bit per lane.
+
+template <typename T>
+struct avx2_ops;
+
+template <>
+struct avx2_ops<float>
+{
+   using vector = __m256;
+   static constexpr std::size_t lanes = 8;
+   UTILS_SIMD_AVX2 static vector load(const float* a) { return _mm256_loadu_ps(a); }
+   UTILS_SIMD_AVX2 static vector set1(const float value) { return _mm256_set1_ps(value); }
+   UTILS_SIMD_AVX2 static unsigned less(const vector a, const vector b)
+   {
+      return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ)));
+   }
+   UTILS_SIMD_AVX2 static unsigned equal(const vector a, const vector b)
+   {
+      return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)));
+   }
+   UTILS_SIMD_AVX2 static unsigned greater_equal(const vector a, const vector b)
+   {
+      return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ)));
+   }
+};
+
+template <>
+struct avx2_ops<double>
+{
+   using vector = __m256d;
+   static constexpr std::size_t lanes = 4;
+   UTILS_SIMD_AVX2 static vector load(const double* a) { return _mm256_loadu_pd(a); }
+   UTILS_SIMD_AVX2 static vector set1(const double value) { return _mm256_set1_pd(value); }
+   UTILS_SIMD_AVX2 static unsigned less(const vector a, const vector b)
+   {
+      return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ)));
+   }
+   UTILS_SIMD_AVX2 static unsigned equal(const vector a, const vector b)
+   {
+      return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)));
+   }
+   UTILS_SIMD_AVX2 static unsigned greater_equal(const vector a, const vector b)
+   {
+      return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GE_OQ)));
+   }
+};
+
+template <>
+struct avx2_ops<std::int32_t>
+{
+   using vector = __m256i;
+   static constexpr std::size_t lanes = 8;
+   UTILS_SIMD_AVX2 static vector load(const std::int32_t* a)
+   {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+   }
+   UTILS_SIMD_AVX2 static vector set1(const std::int32_t value) { return _mm256_set1_epi32(value); }
+   UTILS_SIMD_AVX2 static unsigned mask(const vector m)
+   {
+      return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+   }
+   UTILS_SIMD_AVX2 static unsigned less(const vector a, const vector b)
+   {
+      return mask(_mm256_cmpgt_epi32(b, a));
+   }
+   UTILS_SIMD_AVX2 static unsigned equal(const vector a, const vector b)
+   {
+      return mask(_mm256_cmpeq_epi32(a, b));
+   }
+   UTILS_SIMD_AVX2 static unsigned greater_equal(const vector a, const vector b)
+   {
+      return ~less(a, b) & 0xffu;
+   }
+};
+
+template <>
+struct avx2_ops<std::int64_t>
+{
+   using vector = __m256i;
+   static constexpr std::size_t lanes = 4;
+   UTILS_SIMD_AVX2 static vector load(const std::int64_t* a)
+   {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+   }
+   UTILS_SIMD_AVX2 static vector set1(const std::int64_t value)
+   {
+      return _mm256_set1_epi64x(value);
+   }
+   UTILS_SIMD_AVX2 static unsigned mask(const vector m)
+   {
+      return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+   }
+   UTILS_SIMD_AVX2 static unsigned less(const vector a, const vector b)
+   {
+      return mask(_mm256_cmpgt_epi64(b, a));
+   }
+   UTILS_SIMD_AVX2 static unsigned equal(const vector a, const vector b)
+   {
+      return mask(_mm256_cmpeq_epi64(a, b));
+   }
+   UTILS_SIMD_AVX2 static unsigned greater_equal(const vector a, const vector b)
+   {
+      return ~less(a, b) & 0xfu;
+   }
+};
+
+/// @brief For each 4-bit mask, the permutation of 32-bit lanes that moves the 64-bit lanes
+/// selected by the mask to the front.
+
+struct compress_permutations
+{
+   compress_permutations()
+   {
+      for (unsigned mask = 0; mask < 16; ++mask)
+      {
+         unsigned position = 0;
+         for (unsigned lane = 0; lane < 4; ++lane)
+         {
+            if (mask & (1u << lane))
+            {
+               m_permutations[mask][2 * position] = static_cast<std::int32_t>(2 * lane);
+               m_permutations[mask][2 * position + 1] = static_cast<std::int32_t>(2 * lane + 1);
+               ++position;
+            }
+         }
+         for (; position < 4; ++position)
+         {
+            m_permutations[mask][2 * position] = 0;
+            m_permutations[mask][2 * position + 1] = 1;
+         }
+      }
+   }
+
+   alignas(32) std::int32_t m_permutations[16][8];
+};
+
+const compress_permutations g_compress_permutations;
+
+template <typename Ops>
+UTILS_SIMD_AVX2 unsigned avx2_mask(comparison_constant<comparison::less>,
+                                   const typename Ops::vector value,
+                                   const typename Ops::vector low, const typename Ops::vector)
+{
+   return Ops::less(value, low);
+}
+
+template <typename Ops>
+UTILS_SIMD_AVX2 unsigned avx2_mask(comparison_constant<comparison::equal>,
+                                   const typename Ops::vector value,
+                                   const typename Ops::vector low, const typename Ops::vector)
+{
+   return Ops::equal(value, low);
+}
+
+template <typename Ops>
+UTILS_SIMD_AVX2 unsigned avx2_mask(comparison_constant<comparison::in_range>,
+                                   const typename Ops::vector value,
+                                   const typename Ops::vector low,
+                                   const typename Ops::vector high)
+{
+   return Ops::greater_equal(value, low) & Ops::less(value, high);
+}
+
+struct avx2_select
+{
+   /// @details Compresses the indices of each group of four lanes with a permutation from
+   /// g_compress_permutations and stores all four, of which the unselected ones are overwritten
+   /// by the next group (hence select_slack).
+   template <comparison Kind, typename T>
+   __attribute__((target("avx2"))) static std::size_t select_kind(
+      const T* a, const std::size_t n, const T low, const T high, const std::uint64_t first_index,
+      std::uint64_t* out)
+   {
+      using ops = avx2_ops<T>;
+      const typename ops::vector low_vector = ops::set1(low);
+      const typename ops::vector high_vector = ops::set1(high);
+      const __m256i step = _mm256_set1_epi64x(4);
+      __m256i indices = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>(first_index)),
+                                         _mm256_set_epi64x(3, 2, 1, 0));
+      std::uint64_t* const begin = out;
+      std::size_t i = 0;
+      for (; i + ops::lanes <= n; i += ops::lanes)
+      {
+         const unsigned mask = avx2_mask<ops>(comparison_constant<Kind>(), ops::load(a + i),
+                                              low_vector, high_vector);
+         for (std::size_t group = 0; group < ops::lanes; group += 4)
+         {
+            const unsigned group_mask = (mask >> group) & 0xfu;
+            const __m256i permutation = _mm256_load_si256(reinterpret_cast<const __m256i*>(
+               g_compress_permutations.m_permutations[group_mask]));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                                _mm256_permutevar8x32_epi32(indices, permutation));
+            out += __builtin_popcount(group_mask);
+            indices = _mm256_add_epi64(indices, step);
+         }
+      }
+      out += select_tail<Kind>(a, i, n, low, high, first_index, out);
+      return static_cast<std::size_t>(out - begin);
+   }
+
+   template <comparison Kind, typename T>
+   __attribute__((target("avx2"))) static std::size_t count_kind(const T* a, const std::size_t n,
+                                                                   const T low, const T high)
+   {
+      using ops = avx2_ops<T>;
+      const typename ops::vector low_vector = ops::set1(low);
+      const typename ops::vector high_vector = ops::set1(high);
+      std::size_t count = 0;
+      std::size_t i = 0;
+      for (; i + ops::lanes <= n; i += ops::lanes)
+         count += __builtin_popcount(avx2_mask<ops>(comparison_constant<Kind>(), ops::load(a + i),
+                                                    low_vector, high_vector));
+      return count + count_tail<Kind>(a, i, n, low, high);
+   }
+
+   template <typename T>
+   static std::size_t select(const T* a, const std::size_t n, const comparison kind, const T low,
+                             const T high, const std::uint64_t first_index, std::uint64_t* out)
+   {
+      UTILS_SIMD_SELECT_DISPATCH(select_kind, a, n, low, high, first_index, out)
+   }
+
+   template <typename T>
+   static std::size_t count(const T* a, const std::size_t n, const comparison kind, const T low,
+                            const T high)
+   {
+      UTILS_SIMD_SELECT_DISPATCH(count_kind, a, n, low, high)
+   }
+};
+
+#undef UTILS_SIMD_AVX2
+
+//--------------------------------------------------------------------------------------------------
+
+#define UTILS_SIMD_AVX512                                                                          \
+   __attribute__((target("avx512f,avx512bw,avx512dq"), always_inline)) inline
+
+/// @brief Comparisons of AVX-512 registers of T, yielding one mask bit per lane.
+
+template <typename T>
+struct avx512_ops;
+
+template <>
+struct avx512_ops<float>
+{
+   using vector = __m512;
+   static constexpr std::size_t lanes = 16;
+   UTILS_SIMD_AVX512 static vector load(const float* a) { return _mm512_loadu_ps(a); }
+   UTILS_SIMD_AVX512 static vector set1(const float value) { return _mm512_set1_ps(value); }
+   UTILS_SIMD_AVX512 static unsigned less(const vector a, const vector b)
+   {
+      return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);
+   }
+   UTILS_SIMD_AVX512 static unsigned equal(const vector a, const vector b)
+   {
+      return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);
+   }
+   UTILS_SIMD_AVX512 static unsigned greater_equal(const vector a, const vector b)
+   {
+      return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ);
+   }
+};
+
+template <>
+struct avx512_ops<double>
+{
+   using vector = __m512d;
+   static constexpr std::size_t lanes = 8;
+   UTILS_SIMD_AVX512 static vector load(const double* a) { return _mm512_loadu_pd(a); }
+   UTILS_SIMD_AVX512 static vector set1(const double value) { return _mm512_set1_pd(value); }
+   UTILS_SIMD_AVX512 static unsigned less(const vector a, const vector b)
+   {
+      return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ);
+   }
+   UTILS_SIMD_AVX512 static unsigned equal(const vector a, const vector b)
+   {
+      return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ);
+   }
+   UTILS_SIMD_AVX512 static unsigned greater_equal(const vector a, const vector b)
+   {
+      return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ);
+   }
+};
+
+template <>
+struct avx512_ops<std::int32_t>
+{
+   using vector = __m512i;
+   static constexpr std::size_t lanes = 16;
+   UTILS_SIMD_AVX512 static vector load(const std::int32_t* a) { return _mm512_loadu_si512(a); }
+   UTILS_SIMD_AVX512 static vector set1(const std::int32_t value)
+   {
+      return _mm512_set1_epi32(value);
+   }
+   UTILS_SIMD_AVX512 static unsigned less(const vector a, const vector b)
+   {
+      return _mm512_cmplt_epi32_mask(a, b);
+   }
+   UTILS_SIMD_AVX512 static unsigned equal(const vector a, const vector b)
+   {
+      return _mm512_cmpeq_epi32_mask(a, b);
+   }
+   UTILS_SIMD_AVX512 static unsigned greater_equal(const vector a, const vector b)
+   {
+      return _mm512_cmpge_epi32_mask(a, b);
+   }
+};
+
+template <>
+struct avx512_ops<std::int64_t>
+{
+   using vector = __m512i;
+   static constexpr std::size_t lanes = 8;
+   UTILS_SIMD_AVX512 static vector load(const std::int64_t* a) { return _mm512_loadu_si512(a); }
+   UTILS_SIMD_AVX512 static vector set1(const std::int64_t value)
+   {
+      return _mm512_set1_epi64(value);
+   }
+   UTILS_SIMD_AVX512 static unsigned less(const vector a, const vector b)
+   {
+      return _mm512_cmplt_epi64_mask(a, b);
+   }
+   UTILS_SIMD_AVX512 static unsigned equal(const vector a, const vector b)
+   {
+      return _mm512_cmpeq_epi64_mask(a, b);
+   }
+   UTILS_SIMD_AVX512 static unsigned greater_equal(const vector a, const vector b)
+   {
+      return _mm512_cmpge_epi64_mask(a, b);
+   }
+};
+
+template <typename Ops>
+UTILS_SIMD_AVX512 unsigned avx512_mask(comparison_constant<comparison::less>,
+                                       const typename Ops::vector value,
+                                       const typename Ops::vector low, const typename Ops::vector)
+{
+   return Ops::less(value, low);
+}
+
+template <typename Ops>
+UTILS_SIMD_AVX512 unsigned avx512_mask(comparison_constant<comparison::equal>,
+                                       const typename Ops::vector value,
+                                       const typename Ops::vector low, const typename Ops::vector)
+{
+   return Ops::equal(value, low);
+}
+
+template <typename Ops>
+UTILS_SIMD_AVX512 unsigned avx512_mask(comparison_constant<comparison::in_range>,
+                                       const typename Ops::vector value,
+                                       const typename Ops::vector low,
+                                       const typename Ops::vector high)
+{
+   return Ops::greater_equal(value, low) & Ops::less(value, high);
+}
+
+struct avx512_select
+{
+   /// @details Stores the selected indices of each group of eight lanes with a compressing
+   /// store, which writes only the selected lanes.
+   template <comparison Kind, typename T>
+   __attribute__((target("avx512f,avx512bw,avx512dq"))) static std::size_t select_kind(
+      const T* a, const std::size_t n, const T low, const T high, const std::uint64_t first_index,
+      std::uint64_t* out)
+   {
+      using ops = avx512_ops<T>;
+      const typename ops::vector low_vector = ops::set1(low);
+      const typename ops::vector high_vector = ops::set1(high);
+      const __m512i step = _mm512_set1_epi64(8);
+      __m512i indices = _mm512_add_epi64(_mm512_set1_epi64(static_cast<long long>(first_index)),
+                                         _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+      std::uint64_t* const begin = out;
+      std::size_t i = 0;
+      for (; i + ops::lanes <= n; i += ops::lanes)
+      {
+         const unsigned mask = avx512_mask<ops>(comparison_constant<Kind>(), ops::load(a + i),
+                                                low_vector, high_vector);
+         for (std::size_t group = 0; group < ops::lanes; group += 8)
+         {
+            const __mmask8 group_mask = static_cast<__mmask8>(mask >> group);
+            _mm512_mask_compressstoreu_epi64(out, group_mask, indices);
+            out += __builtin_popcount(group_mask);
+            indices = _mm512_add_epi64(indices, step);
+         }
+      }
+      out += select_tail<Kind>(a, i, n, low, high, first_index, out);
+      return static_cast<std::size_t>(out - begin);
+   }
+
+   template <comparison Kind, typename T>
+   __attribute__((target("avx512f,avx512bw,avx512dq"))) static std::size_t count_kind(
+      const T* a, const std::size_t n, const T low, const T high)
+   {
+      using ops = avx512_ops<T>;
+      const typename ops::vector low_vector = ops::set1(low);
+      const typename ops::vector high_vector = ops::set1(high);
+      std::size_t count = 0;
+      std::size_t i = 0;
+      for (; i + ops::lanes <= n; i += ops::lanes)
+         count += __builtin_popcount(avx512_mask<ops>(
+            comparison_constant<Kind>(), ops::load(a + i), low_vector, high_vector));
+      return count + count_tail<Kind>(a, i, n, low, high);
+   }
+
+   template <typename T>
+   static std::size_t select(const T* a, const std::size_t n, const comparison kind, const T low,
+                             const T high, const std::uint64_t first_index, std::uint64_t* out)
+   {
+      UTILS_SIMD_SELECT_DISPATCH(select_kind, a, n, low, high, first_index, out)
+   }
+
+   template <typename T>
+   static std::size_t count(const T* a, const std::size_t n, const comparison kind, const T low,
+                            const T high)
+   {
+      UTILS_SIMD_SELECT_DISPATCH(count_kind, a, n, low, high)
+   }
+};
+
+#undef UTILS_SIMD_AVX512
+#undef UTILS_SIMD_SELECT_DISPATCH
+
+//--------------------------------------------------------------------------------------------------
+
+#undef UTILS_SIMD_INLINE
+
+template <typename T, typename Target, typename Select>
+detail::kernel_table<T> make_kernel_table()
+{
+   return {&Target::template transform<T, T, add_op>,
+           &Target::template transform<T, T, sub_op>,
+           &Target::template transform<T, T, mul_op>,
+           &Target::template transform<T, T, min_op>,
+           &Target::template transform<T, T, max_op>,
+           &Target::template transform<T, std::uint8_t, less_op>,
+           &Target::template transform<T, std::uint8_t, equal_op>,
+           &Target::template reduce<T, add_op>,
+           &Target::template reduce<T, min_op>,
+           &Target::template reduce<T, max_op>,
+           &Target::template dot<T>,
+           &Target::template fill<T>,
+           &Target::template copy<T>,
+           &Select::template select<T>,
+           &Select::template count<T>};
+}
+
+std::atomic<isa> g_max_isa(isa::avx512);
+
+}   // end namespace
+
+//--------------------------------------------------------------------------------------------------
+
+const char* to_string(const isa set)
+{
+   switch (set)
+   {
+      case isa::scalar:
+         return "scalar";
+      case isa::avx2:
+         return "avx2";
+      case isa::avx512:
+         return "avx512";
+   }
+   return "unknown";
+}
+
+isa detected_isa()
+{
+   static const isa detected = [] {
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+          __builtin_cpu_supports("avx512dq"))
+         return isa::avx512;
+      if (__builtin_cpu_supports("avx2"))
+         return isa::avx2;
+      return isa::scalar;
+   }();
+   return detected;
+}
+
+isa active_isa()
+{
+   const isa max = g_max_isa.load(std::memory_order_relaxed);
+   const isa detected = detected_isa();
+   return max < detected ? max : detected;
+}
+
+void set_max_isa(const isa max)
+{
+   g_max_isa.store(max, std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+template <typename T>
+const kernel_table<T>& kernels()
+{
+   static const kernel_table<T> tables[] = {make_kernel_table<T, scalar_target, scalar_select>(),
+                                            make_kernel_table<T, avx2_target, avx2_select>(),
+                                            make_kernel_table<T, avx512_target, avx512_select>()};
+   return tables[static_cast<int>(active_isa())];
+}
+
+template const kernel_table<float>& kernels<float>();
+template const kernel_table<double>& kernels<double>();
+template const kernel_table<std::int32_t>& kernels<std::int32_t>();
+template const kernel_table<std::int64_t>& kernels<std::int64_t>();
+
+}   // end namespace detail
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace simd
+}   // end namespace utils
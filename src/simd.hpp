@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+//--------------------------------------------------------------------------------------------------
+/// @file simd.hpp
+/// @brief Vectorized numeric kernels, selected at run time for the instruction sets the processor
+/// supports, and aligned allocation of numeric storage.
+/// @details Every kernel is compiled for AVX-512, for AVX2 and for the baseline target. On first
+/// use, the best variant the processor supports (CPUID) is chosen. The kernels accept any pointers
+/// and sizes, but are fastest on storage aligned to simd::alignment.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace simd {
+
+//--------------------------------------------------------------------------------------------------
+
+enum class isa
+{
+   scalar,
+   avx2,
+   avx512
+};
+
+const char* to_string(isa set);
+
+/// @brief Returns the best instruction set the processor supports.
+isa detected_isa();
+
+/// @brief Returns the instruction set the kernels currently use.
+isa active_isa();
+
+/// @brief Limits the instruction set the kernels use, e.g. to compare against the scalar fallback.
+void set_max_isa(isa max);
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Alignment of numeric storage, the width of an AVX-512 register.
+constexpr std::size_t alignment = 64;
+
+/// @brief Returns the number of elements of type T in a register of alignment bytes.
+template <typename T>
+constexpr std::size_t lanes()
+{
+   return alignment / sizeof(T);
+}
+
+/// @brief Rounds size up to a whole number of lanes.
+template <typename T>
+constexpr std::size_t padded_size(const std::size_t size)
+{
+   return (size + lanes<T>() - 1) / lanes<T>() * lanes<T>();
+}
+
+/// @brief Allocates bytes aligned to alignment. Throws std::bad_alloc on failure.
+inline void* allocate_aligned(const std::size_t bytes)
+{
+   void* memory = nullptr;
+   if (::posix_memalign(&memory, alignment, bytes) != 0)
+      throw std::bad_alloc();
+   return memory;
+}
+
+inline void deallocate_aligned(void* memory)
+{
+   std::free(memory);
+}
+
+/// @brief Allocator whose allocations are aligned to alignment.
+
+template <typename T>
+class aligned_allocator
+{
+public:
+   using value_type = T;
+
+   aligned_allocator() = default;
+
+   template <typename U>
+   aligned_allocator(const aligned_allocator<U>&) noexcept
+   {
+   }
+
+   T* allocate(const std::size_t n)
+   {
+      if (n > static_cast<std::size_t>(-1) / sizeof(T) - alignment)
+         throw std::bad_alloc();
+      return static_cast<T*>(allocate_aligned(n * sizeof(T)));
+   }
+
+   void deallocate(T* memory, std::size_t)
+   {
+      deallocate_aligned(memory);
+   }
+
+};   // end class template aligned_allocator
+
+template <typename T, typename U>
+bool operator==(const aligned_allocator<T>&, const aligned_allocator<U>&)
+{
+   return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const aligned_allocator<T>&, const aligned_allocator<U>&)
+{
+   return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Comparisons of elements with constants, for which select_indices is vectorized: a < low,
+/// a == low, and low <= a < high.
+enum class comparison
+{
+   less,
+   equal,
+   in_range
+};
+
+/// @brief Number of indices beyond the selected ones that select_indices may overwrite.
+constexpr std::size_t select_slack = 8;
+
+/// @brief Whether the kernels are instantiated for T.
+template <typename T>
+struct is_simd_type
+: std::integral_constant<bool, std::is_same<T, float>::value || std::is_same<T, double>::value ||
+                                  std::is_same<T, std::int32_t>::value ||
+                                  std::is_same<T, std::int64_t>::value>
+{
+};
+
+namespace detail {
+
+template <typename T>
+struct kernel_table
+{
+   void (*m_add)(const T*, const T*, T*, std::size_t);
+   void (*m_sub)(const T*, const T*, T*, std::size_t);
+   void (*m_mul)(const T*, const T*, T*, std::size_t);
+   void (*m_min)(const T*, const T*, T*, std::size_t);
+   void (*m_max)(const T*, const T*, T*, std::size_t);
+   void (*m_less)(const T*, const T*, std::uint8_t*, std::size_t);
+   void (*m_equal)(const T*, const T*, std::uint8_t*, std::size_t);
+   T (*m_sum)(const T*, std::size_t, T);
+   T (*m_min_value)(const T*, std::size_t, T);
+   T (*m_max_value)(const T*, std::size_t, T);
+   T (*m_dot)(const T*, const T*, std::size_t);
+   void (*m_fill)(T*, std::size_t, T);
+   void (*m_copy)(const T*, T*, std::size_t);
+   std::size_t (*m_select)(const T*, std::size_t, comparison, T, T, std::uint64_t, std::uint64_t*);
+   std::size_t (*m_count)(const T*, std::size_t, comparison, T, T);
+};
+
+/// @brief Returns the kernels for the active instruction set.
+template <typename T>
+const kernel_table<T>& kernels();
+
+extern template const kernel_table<float>& kernels<float>();
+extern template const kernel_table<double>& kernels<double>();
+extern template const kernel_table<std::int32_t>& kernels<std::int32_t>();
+extern template const kernel_table<std::int64_t>& kernels<std::int64_t>();
+
+}   // end namespace detail
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Element-wise out[i] = a[i] op b[i] for i in [0,n). out may be a or b.
+
+template <typename T>
+void add(const T* a, const T* b, T* out, const std::size_t n)
+{
+   detail::kernels<T>().m_add(a, b, out, n);
+}
+
+template <typename T>
+void sub(const T* a, const T* b, T* out, const std::size_t n)
+{
+   detail::kernels<T>().m_sub(a, b, out, n);
+}
+
+template <typename T>
+void mul(const T* a, const T* b, T* out, const std::size_t n)
+{
+   detail::kernels<T>().m_mul(a, b, out, n);
+}
+
+template <typename T>
+void min(const T* a, const T* b, T* out, const std::size_t n)
+{
+   detail::kernels<T>().m_min(a, b, out, n);
+}
+
+template <typename T>
+void max(const T* a, const T* b, T* out, const std::size_t n)
+{
+   detail::kernels<T>().m_max(a, b, out, n);
+}
+
+/// @brief Element-wise comparisons, setting out[i] to 1 if the comparison holds and to 0 if not.
+
+template <typename T>
+void less(const T* a, const T* b, std::uint8_t* out, const std::size_t n)
+{
+   detail::kernels<T>().m_less(a, b, out, n);
+}
+
+template <typename T>
+void equal(const T* a, const T* b, std::uint8_t* out, const std::size_t n)
+{
+   detail::kernels<T>().m_equal(a, b, out, n);
+}
+
+/// @brief Reductions of a[0,n). Floating-point sums are accumulated in lanes, so their rounding
+/// can differ from a sequential sum.
+
+template <typename T>
+T sum(const T* a, const std::size_t n)
+{
+   return detail::kernels<T>().m_sum(a, n, T());
+}
+
+/// @pre n > 0
+template <typename T>
+T min_value(const T* a, const std::size_t n)
+{
+   return detail::kernels<T>().m_min_value(a, n, a[0]);
+}
+
+/// @pre n > 0
+template <typename T>
+T max_value(const T* a, const std::size_t n)
+{
+   return detail::kernels<T>().m_max_value(a, n, a[0]);
+}
+
+template <typename T>
+T dot(const T* a, const T* b, const std::size_t n)
+{
+   return detail::kernels<T>().m_dot(a, b, n);
+}
+
+template <typename T>
+void fill(T* out, const std::size_t n, const T value)
+{
+   detail::kernels<T>().m_fill(out, n, value);
+}
+
+/// @pre [a,a+n) and [out,out+n) do not overlap.
+template <typename T>
+void copy(const T* a, T* out, const std::size_t n)
+{
+   detail::kernels<T>().m_copy(a, out, n);
+}
+
+/// @brief Writes first_index + i to out, in increasing order, for each i in [0,n) for which a[i]
+/// satisfies the comparison with low (and high), and returns the number of indices written.
+/// @details With AVX-512, the indices of eight elements are written by one compressing store.
+/// With AVX2, they are moved together by a permutation and stored four at a time.
+/// @pre out has room for n + select_slack indices.
+template <typename T>
+std::size_t select_indices(const T* a, const std::size_t n, const comparison kind, const T low,
+                           const T high, const std::uint64_t first_index, std::uint64_t* out)
+{
+   return detail::kernels<T>().m_select(a, n, kind, low, high, first_index, out);
+}
+
+/// @brief Returns the number of elements of a[0,n) that satisfy the comparison with low (and
+/// high).
+template <typename T>
+std::size_t count_matches(const T* a, const std::size_t n, const comparison kind, const T low,
+                          const T high)
+{
+   return detail::kernels<T>().m_count(a, n, kind, low, high);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace simd
+}   // end namespace utils
@@ -0,0 +1,72 @@
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+
+namespace utils {
+namespace threads {
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t thread_pool::default_thread_count()
+{
+   const unsigned hardware = std::thread::hardware_concurrency();
+   return hardware > 2 ? hardware - 1 : 1;
+}
+
+thread_pool::thread_pool(const std::size_t thread_count)
+: m_stop(false)
+{
+   m_threads.reserve(thread_count);
+   for (std::size_t i = 0; i < thread_count; ++i)
+      m_threads.emplace_back(&thread_pool::run, this);
+}
+
+thread_pool::~thread_pool()
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+   }
+   m_queued.notify_all();
+   for (std::thread& thread : m_threads)
+      thread.join();
+}
+
+void thread_pool::enqueue(std::function<void()> task)
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.push_back(std::move(task));
+   }
+   m_queued.notify_one();
+}
+
+void thread_pool::run()
+{
+   while (true)
+   {
+      std::function<void()> task;
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_queued.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+         if (m_tasks.empty())
+            return;
+         task = std::move(m_tasks.front());
+         m_tasks.pop_front();
+      }
+      task();
+   }
+}
+
+thread_pool& default_pool()
+{
+   static thread_pool pool;
+   return pool;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace threads
+}   // end namespace utils
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//--------------------------------------------------------------------------------------------------
+/// @file thread_pool.hpp
+/// @brief A fixed-size pool of worker threads running queued tasks, and data-parallel loops on it.
+/// @author Susanne van den Elsen
+/// @date 2017
+//--------------------------------------------------------------------------------------------------
+
+
+namespace utils {
+namespace threads {
+
+//--------------------------------------------------------------------------------------------------
+
+/// @brief Runs submitted tasks on a fixed number of worker threads, in submission order.
+/// @details The destructor runs the tasks that are still queued and joins the threads.
+
+class thread_pool
+{
+public:
+   /// @brief Returns one less than the hardware concurrency (the calling thread of parallel_for
+   /// works as well), but at least 1.
+   static std::size_t default_thread_count();
+
+   explicit thread_pool(std::size_t thread_count = default_thread_count());
+
+   thread_pool(const thread_pool&) = delete;
+   ~thread_pool();
+
+   thread_pool& operator=(const thread_pool&) = delete;
+
+   std::size_t size() const
+   {
+      return m_threads.size();
+   }
+
+   /// @brief Queues function and returns a future for its result.
+   template <typename Function>
+   std::future<typename std::result_of<Function()>::type> submit(Function&& function)
+   {
+      using result_t = typename std::result_of<Function()>::type;
+      auto task =
+         std::make_shared<std::packaged_task<result_t()>>(std::forward<Function>(function));
+      std::future<result_t> result = task->get_future();
+      enqueue([task] { (*task)(); });
+      return result;
+   }
+
+   /// @brief Calls function(i) for all i in [0,count), on the calling thread and on at most
+   /// size() workers, and returns when all calls have returned.
+   /// @details Indices are claimed dynamically, so that uneven calls balance out. Calling
+   /// parallel_for from a task does not deadlock, as the calling thread never waits for calls
+   /// that have not started. If calls throw, the first exception is rethrown once all calls
+   /// have returned.
+   template <typename Function>
+   void parallel_for(std::size_t count, Function&& function);
+
+private:
+   std::mutex m_mutex;
+
+   std::condition_variable m_queued;
+
+   std::deque<std::function<void()>> m_tasks;
+
+   bool m_stop;
+
+   std::vector<std::thread> m_threads;
+
+   void enqueue(std::function<void()> task);
+
+   void run();
+
+};   // end class thread_pool
+
+/// @brief Returns the process-wide pool, created on first use with the default thread count.
+thread_pool& default_pool();
+
+//--------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+struct parallel_for_state
+{
+   explicit parallel_for_state(const std::size_t count)
+   : m_count(count)
+   , m_next(0)
+   , m_done(0)
+   {
+   }
+
+   const std::size_t m_count;
+
+   std::atomic<std::size_t> m_next;
+
+   std::atomic<std::size_t> m_done;
+
+   std::mutex m_mutex;
+
+   std::condition_variable m_finished;
+
+   std::exception_ptr m_error;
+};
+
+}   // end namespace detail
+
+template <typename Function>
+void thread_pool::parallel_for(const std::size_t count, Function&& function)
+{
+   if (count == 0)
+      return;
+   const auto state = std::make_shared<detail::parallel_for_state>(count);
+   // Workers that start after all indices are claimed return without touching function
+   const auto work = [state, &function] {
+      for (std::size_t i = state->m_next++; i < state->m_count; i = state->m_next++)
+      {
+         try
+         {
+            function(i);
+         }
+         catch (...)
+         {
+            std::lock_guard<std::mutex> lock(state->m_mutex);
+            if (!state->m_error)
+               state->m_error = std::current_exception();
+         }
+         if (++state->m_done == state->m_count)
+         {
+            std::lock_guard<std::mutex> lock(state->m_mutex);
+            state->m_finished.notify_all();
+         }
+      }
+   };
+   const std::size_t helpers = std::min(size(), count - 1);
+   for (std::size_t i = 0; i < helpers; ++i)
+      enqueue(work);
+   work();
+   std::unique_lock<std::mutex> lock(state->m_mutex);
+   state->m_finished.wait(lock, [&state] { return state->m_done == state->m_count; });
+   if (state->m_error)
+      std::rethrow_exception(state->m_error);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+}   // end namespace threads
+}   // end namespace utils
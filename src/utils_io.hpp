@@ -4,6 +4,10 @@
 
 #include <fstream>
 #include <sstream>
+#include "container_input.hpp"
+#include "format_to.hpp"
+#include "mapped_file.hpp"
+#include "memory_resource.hpp"
 
 /*---------------------------------------------------------------------------75*/
 /**
@@ -23,12 +27,109 @@ namespace utils
         template<typename T>
         bool read_from_file(const std::string& filename, T& object)
         {
+            static_assert(!refers_to_source<T>::value,
+                "boost::string_view values refer to the memory they are read from: read them "
+                "with read_from_memory, e.g. from a mapped_file that outlives them");
             std::ifstream ifs(filename);
             ifs >> object;
             ifs.close();
             return !ifs.fail();
         }
 
+        template<typename T>
+        bool read_from_memory(
+            const boost::string_view& text,
+            T& object,
+            std::true_type /* scannable */)
+        {
+            memory_source source(text.data(), text.data() + text.size());
+            container_scanner<memory_source> scanner(source);
+            return scanner.read_container(object);
+        }
+        
+        template<typename T>
+        bool read_from_memory(
+            const boost::string_view& text,
+            T& object,
+            std::false_type /* scannable */)
+        {
+            memory_streambuf buffer(text);
+            std::istream is(&buffer);
+            is >> object;
+            return !is.fail();
+        }
+        
+        /**
+         @brief Reads object from text. Supported containers of values that
+         a container_scanner can read are parsed directly from text; other
+         types are read with operator>> from an istream on text that does
+         not copy it.
+         @note Values of type boost::string_view refer to the memory of text.
+         */
+        template<typename T>
+        bool read_from_memory(const boost::string_view& text, T& object)
+        {
+            return read_from_memory(text, object, is_scannable_container<T, memory_source>{});
+        }
+        
+        /**
+         @brief Modes of reading a file: through an std::ifstream, or by
+         mapping the file into memory and reading from the mapping.
+         */
+        enum class read_mode { stream, mapped };
+        
+        /**
+         @brief Reads object from the given file using the given read_mode.
+         @details In read_mode::mapped, the file is not copied through a
+         stream buffer and supported containers are parsed directly from
+         the mapping (see read_from_memory).
+         @note The mapping is released before returning, so values of type
+         boost::string_view cannot be read: use a mapped_file and
+         read_from_memory.
+         */
+        template<typename T>
+        bool read_from_file(const std::string& filename, T& object, const read_mode mode)
+        {
+            static_assert(!refers_to_source<T>::value,
+                "boost::string_view values refer to the memory they are read from: read them "
+                "with read_from_memory, e.g. from a mapped_file that outlives them");
+            if (mode == read_mode::stream) {
+                return read_from_file(filename, object);
+            }
+            const mapped_file file(filename);
+            return file.is_open() && read_from_memory(file.view(), object);
+        }
+
+        /**
+         @brief Reads the value of snapshot from text, after discarding its
+         previous value. The value and all containers and strings in it
+         that use default-constructed memory::resource_allocators are
+         allocated in the snapshot's arena, so that the whole value can be
+         discarded at once (see memory::arena_snapshot).
+         */
+        template<typename T>
+        bool read_from_memory(const boost::string_view& text, memory::arena_snapshot<T>& snapshot)
+        {
+            snapshot.reset();
+            const memory::resource_scope scope(snapshot.arena());
+            return read_from_memory(text, snapshot.value());
+        }
+        
+        /**
+         @brief Reads the value of snapshot from the given file, like
+         read_from_memory for an arena_snapshot.
+         */
+        template<typename T>
+        bool read_from_file(
+            const std::string& filename,
+            memory::arena_snapshot<T>& snapshot,
+            const read_mode mode=read_mode::stream)
+        {
+            snapshot.reset();
+            const memory::resource_scope scope(snapshot.arena());
+            return read_from_file(filename, snapshot.value(), mode);
+        }
+
         template<typename T>
         bool write_to_file(
             const std::string& filename,
@@ -36,17 +137,25 @@ namespace utils
             std::ios_base::openmode mode=std::ios_base::out)
         {
             std::ofstream ofs(filename, mode);
-            ofs << t << std::endl;
+            ofs << t << '\n';
             ofs.close();
             return !ofs.fail();
         }
     
+        /**
+         @brief Returns the text operator<< produces for t on a stream with
+         default formatting state.
+         @details Formats t with format_to, which handles arithmetic types,
+         strings, std::pair and supported containers without a stream, and
+         moves the result out of the buffer. For repeated formatting without
+         allocation, see to_string_view and to_small_string.
+         */
         template<typename T>
         std::string to_string(const T& t)
         {
-            std::stringstream ss{};
-            ss << t;
-            return ss.str();
+            format_buffer buffer;
+            format_to(buffer, t);
+            return buffer.release();
         }
     } // end namespace io
 } // end namespace utils
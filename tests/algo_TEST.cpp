@@ -0,0 +1,185 @@
+
+#include <algo.hpp>
+#include <simd.hpp>
+#include <threads/thread_pool.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------
+
+namespace utils {
+namespace algo {
+namespace test {
+
+namespace {
+
+/// @brief Checks copy_index_if with pred, sequential and parallel, against a plain loop.
+template <typename T, typename Predicate>
+void expect_selects_indices(const std::vector<T>& values, const Predicate pred)
+{
+   std::vector<std::int64_t> expected;
+   for (std::size_t i = 0; i < values.size(); ++i)
+      if (pred(values[i]))
+         expected.push_back(static_cast<std::int64_t>(i) - 3);
+
+   std::vector<std::int64_t> indices;
+   std::int64_t index = -3;
+   copy_index_if(values.begin(), values.end(), std::back_inserter(indices), pred, index);
+   EXPECT_EQ(expected, indices);
+   EXPECT_EQ(static_cast<std::int64_t>(values.size()) - 3, index);
+
+   std::vector<std::int64_t> parallel(values.size());
+   parallel.erase(copy_index_if(execution::par, values.data(), values.data() + values.size(),
+                                parallel.begin(), pred, std::int64_t(-3)),
+                  parallel.end());
+   EXPECT_EQ(expected, parallel);
+}
+
+template <typename T>
+void expect_selects_indices()
+{
+   for (const std::size_t n : {std::size_t(0), std::size_t(13), 2 * detail::min_chunk_size + 29})
+   {
+      std::vector<T> values(n);
+      for (std::size_t i = 0; i < n; ++i)
+         values[i] = static_cast<T>((i * 7919) % 1000);
+      expect_selects_indices(values, less_than(T(300)));
+      expect_selects_indices(values, equal_to(T(919)));
+      expect_selects_indices(values, in_range(T(250), T(750)));
+   }
+}
+
+}   // end namespace
+
+TEST(ThreadPoolTest, SubmitAndParallelFor)
+{
+   threads::thread_pool pool(3);
+   std::future<int> answer = pool.submit([] { return 42; });
+   EXPECT_EQ(42, answer.get());
+
+   std::vector<std::atomic<int>> calls(1000);
+   pool.parallel_for(calls.size(), [&calls](const std::size_t i) { ++calls[i]; });
+   for (const auto& count : calls)
+      EXPECT_EQ(1, count.load());
+
+   // Nested calls from tasks
+   std::atomic<int> total(0);
+   pool.parallel_for(8, [&pool, &total](std::size_t) {
+      pool.parallel_for(8, [&total](std::size_t) { ++total; });
+   });
+   EXPECT_EQ(64, total.load());
+
+   EXPECT_THROW(pool.parallel_for(10,
+                                  [](const std::size_t i) {
+                                     if (i == 7)
+                                        throw std::runtime_error("7");
+                                  }),
+                std::runtime_error);
+}
+
+TEST(AlgoTest, ParallelCompaction)
+{
+   std::vector<std::int64_t> values(5 * detail::min_chunk_size + 17);
+   for (std::size_t i = 0; i < values.size(); ++i)
+      values[i] = static_cast<std::int64_t>((i * 7919) % 1000);
+   const auto pred = [](const std::int64_t value) { return value < 300; };
+   const auto op = [](const std::int64_t value) { return 2 * value; };
+
+   std::vector<std::int64_t> expected;
+   transform_if(values.begin(), values.end(), std::back_inserter(expected), pred, op);
+   for (const auto& policy_result : {0, 1})
+   {
+      std::vector<std::int64_t> result(values.size());
+      const auto end =
+         policy_result == 0
+            ? transform_if(execution::par, values.begin(), values.end(), result.begin(), pred, op)
+            : transform_if(execution::seq, values.begin(), values.end(), result.begin(), pred, op);
+      result.erase(end, result.end());
+      EXPECT_EQ(expected, result);
+   }
+
+   std::vector<std::size_t> indices;
+   copy_index_if(values.begin(), values.end(), std::back_inserter(indices), pred, std::size_t(10));
+   ASSERT_FALSE(indices.empty());
+   EXPECT_TRUE(pred(values[indices.front() - 10]));
+   std::vector<std::size_t> parallel(values.size());
+   parallel.erase(copy_index_if(execution::par_unseq, values.data(), values.data() + values.size(),
+                                parallel.begin(), pred, std::size_t(10)),
+                  parallel.end());
+   EXPECT_EQ(indices, parallel);
+}
+
+TEST(AlgoTest, ParallelFindIfWithIndex)
+{
+   std::vector<int> values(6 * detail::min_chunk_size, 0);
+   const auto pred = [](const std::size_t index, const int value) {
+      return value == 1 && index % 2 == 1;
+   };
+   EXPECT_EQ(values.end(), find_if_with_index(execution::par, values.begin(), values.end(), pred));
+   for (const std::size_t i : {std::size_t(3), 2 * detail::min_chunk_size + 1})
+      values[i] = 1;
+   values[4 * detail::min_chunk_size] = 1;   // even index, no match
+   values.back() = 1;
+   EXPECT_EQ(values.begin() + 3, find_if_with_index(values.begin(), values.end(), pred));
+   EXPECT_EQ(values.begin() + 3,
+             find_if_with_index(execution::par, values.begin(), values.end(), pred));
+   values[3] = 0;
+   EXPECT_EQ(values.begin() + 2 * detail::min_chunk_size + 1,
+             find_if_with_index(execution::par, values.begin(), values.end(), pred));
+   EXPECT_EQ(values.begin() + 2 * detail::min_chunk_size + 1,
+             find_if_with_index(execution::seq, values.begin(), values.end(), pred));
+}
+
+TEST(AlgoTest, SimdIndexSelection)
+{
+   for (const simd::isa set : {simd::isa::scalar, simd::isa::avx2, simd::isa::avx512})
+   {
+      if (set > simd::detected_isa())
+         continue;
+      simd::set_max_isa(set);
+      SCOPED_TRACE(simd::to_string(simd::active_isa()));
+      expect_selects_indices<float>();
+      expect_selects_indices<double>();
+      expect_selects_indices<std::int32_t>();
+      expect_selects_indices<std::int64_t>();
+   }
+   simd::set_max_isa(simd::isa::avx512);
+
+   // Predicates on mismatching value types fall back to calling them per element
+   const std::vector<double> values{0.5, 2.5, 1.5};
+   std::vector<int> indices;
+   copy_index_if(values.begin(), values.end(), std::back_inserter(indices), less_than(2), 0);
+   EXPECT_EQ((std::vector<int>{0, 2}), indices);
+
+   // The elements are not converted to the type of the constants
+   const std::vector<double> fractions{-0.5, 0.5, 1.5};
+   indices.clear();
+   copy_index_if(fractions.begin(), fractions.end(), std::back_inserter(indices), in_range(0, 1),
+                 0);
+   EXPECT_EQ((std::vector<int>{1}), indices);
+   const std::vector<std::int64_t> large{(std::int64_t(1) << 32) + 1, 7, 3};
+   indices.clear();
+   copy_index_if(large.begin(), large.end(), std::back_inserter(indices), less_than(5), 0);
+   EXPECT_EQ((std::vector<int>{2}), indices);
+   const std::vector<unsigned> naturals{0, 1, 4000000000u};
+   indices.clear();
+   copy_index_if(naturals.begin(), naturals.end(), std::back_inserter(indices), less_than(-1), 0);
+   EXPECT_TRUE(indices.empty());
+   copy_index_if(naturals.begin(), naturals.end(), std::back_inserter(indices), in_range(-1, 2), 0);
+   EXPECT_EQ((std::vector<int>{0, 1}), indices);
+   const std::vector<int> integers{-1, 3};
+   indices.clear();
+   copy_index_if(integers.begin(), integers.end(), std::back_inserter(indices), equal_to(3u), 0);
+   EXPECT_EQ((std::vector<int>{1}), indices);
+}
+
+}   // end namespace test
+}   // end namespace algo
+}   // end namespace utils
@@ -0,0 +1,617 @@
+
+#include <async_file_writer.hpp>
+#include <binary_io.hpp>
+#include <container_io.hpp>
+#include <container_visitor.hpp>
+#include <format_to.hpp>
+#include <parallel_read.hpp>
+#include <utils_io.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+
+//--------------------------------------------------------------------------------------------------
+
+namespace utils {
+namespace io {
+namespace test {
+
+namespace {
+
+/// @brief Reads the elements of a Container from input with the container_istream_iterator or
+/// the container_scanner and returns the resulting stream state.
+template <typename Container, typename Scannable>
+std::ios_base::iostate read(const std::string& input, Container& container, Scannable scannable)
+{
+   std::istringstream is(input);
+   const container_format<Container> format{};
+   container_inserter<Container> inserter(container);
+   is >> std::ws;
+   read_elements<typename read_value<Container>::type>(is, format.mFormat, inserter, scannable);
+   return is.rdstate();
+}
+
+template <typename Container>
+void expect_same_as_iterator(const std::string& input)
+{
+   Container scanned{}, iterated{};
+   EXPECT_EQ(read(input, iterated, std::false_type{}), read(input, scanned, std::true_type{}))
+      << input;
+   EXPECT_EQ(iterated, scanned) << input;
+}
+
+/// @brief Node of a singly linked list whose operator<< formats the tail with format_to.
+struct list_node
+{
+   int mValue;
+   const list_node* mNext;
+};
+
+std::ostream& operator<<(std::ostream& os, const list_node& node)
+{
+   os << node.mValue;
+   if (node.mNext)
+   {
+      format_buffer tail;
+      format_to(tail, *node.mNext);
+      os << "->" << tail.view();
+   }
+   return os;
+}
+
+/// @brief Node of a tree whose operator<< formats the subtrees with to_string.
+struct tree_node
+{
+   int mValue;
+   std::vector<tree_node> mChildren;
+};
+
+std::ostream& operator<<(std::ostream& os, const tree_node& node)
+{
+   os << node.mValue;
+   for (const tree_node& child : node.mChildren)
+      os << '[' << to_string(child) << ']';
+   return os;
+}
+
+/// @brief Value whose operator<< leaves the stream in hexadecimal mode.
+struct hex_value
+{
+   int mValue;
+   bool mHex;
+};
+
+std::ostream& operator<<(std::ostream& os, const hex_value& value)
+{
+   if (value.mHex)
+      os << std::hex << std::setfill('0') << std::setw(4);
+   return os << value.mValue;
+}
+
+}   // end namespace
+
+TEST(ContainerInputTest, ScannerMatchesIterator)
+{
+   for (const auto& input : {"<1,2,3>", "  <1,-2,+3>x", "<1,,2>", "<,1>", "<>", "<1,2", "<1 2>",
+                             "<1,2,>", "<0x3>", "<2147483648>", "<-2147483648>", "<", ""})
+      expect_same_as_iterator<std::vector<int>>(input);
+
+   for (const auto& input : {"<1.5,2e3,-0.1>", "<.5,5.>", "<1e>", "<1e+>", "<.>", "<1e999>"})
+      expect_same_as_iterator<std::vector<double>>(input);
+
+   for (const auto& input : {"<(1,2),(3,4)>", "<(1,2), (3,4)>", "<(1 2)>", "<(1,2)(3,4)>"})
+      expect_same_as_iterator<std::vector<std::pair<int, unsigned>>>(input);
+
+   expect_same_as_iterator<std::unordered_map<int, long>>("{(1,2),(3,-4)}");
+   expect_same_as_iterator<std::set<char>>("{c, a,b}");
+   expect_same_as_iterator<std::list<bool>>("[1,0,2]");
+}
+
+TEST(ContainerInputTest, FallsBackOnNonDefaultStreamState)
+{
+   std::istringstream is("<10,ff>");
+   std::vector<int> vector;
+   is >> std::hex >> vector;
+   ASSERT_FALSE(is.fail());
+   EXPECT_EQ((std::vector<int>{16, 255}), vector);
+}
+
+TEST(ContainerInputTest, ReusesContainerLocales)
+{
+   const std::locale original = std::locale::classic();
+   const container_format_values list_format{'[', ']', ','};
+   const std::locale list_locale = container_locale(original, list_format);
+   EXPECT_TRUE(list_locale == container_locale(original, list_format));
+   EXPECT_FALSE(list_locale == container_locale(original, {'[', ')', ','}));
+   EXPECT_TRUE(std::isspace(']', list_locale));
+   EXPECT_FALSE(std::isspace(']', original));
+
+   std::istringstream is("[[a,b],[c]]");
+   std::list<std::list<std::string>> lists;
+   is >> lists;
+   ASSERT_FALSE(is.fail());
+   EXPECT_EQ((std::list<std::list<std::string>>{{"a", "b"}, {"c"}}), lists);
+   EXPECT_TRUE(is.getloc() == std::locale());
+}
+
+TEST(ContainerInputTest, ReadPair)
+{
+   std::istringstream is("(-1,2.5)");
+   std::pair<long, double> pair;
+   is >> pair;
+   ASSERT_FALSE(is.fail());
+   EXPECT_EQ(std::make_pair(-1L, 2.5), pair);
+}
+
+TEST(ContainerInputTest, ReadNested)
+{
+   std::istringstream is("<<1,2>,<3>,<>>");
+   std::vector<std::vector<int>> vector;
+   is >> vector;
+   ASSERT_FALSE(is.fail());
+   EXPECT_EQ((std::vector<std::vector<int>>{{1, 2}, {3}, {}}), vector);
+}
+
+TEST(ContainerInputTest, AppendInInputOrder)
+{
+   std::istringstream is("<3,4>[2,3][4]");
+   std::vector<int> vector{1, 2};
+   std::forward_list<int> list{1};
+   is >> vector >> list;
+   ASSERT_FALSE(is.fail());
+   EXPECT_EQ((std::vector<int>{1, 2, 3, 4}), vector);
+   EXPECT_EQ((std::forward_list<int>{1, 2, 3}), list);
+   is >> list;
+   EXPECT_EQ((std::forward_list<int>{1, 2, 3, 4}), list);
+}
+
+TEST(ContainerInputTest, ReadArray)
+{
+   std::array<int, 3> array{};
+   std::istringstream is("[1,2,3]");
+   is >> array;
+   ASSERT_FALSE(is.fail());
+   EXPECT_EQ((std::array<int, 3>{{1, 2, 3}}), array);
+
+   std::istringstream too_short("[1,2]");
+   too_short >> array;
+   EXPECT_TRUE(too_short.fail());
+
+   std::istringstream too_long("[1,2,3,4]");
+   too_long >> array;
+   EXPECT_TRUE(too_long.fail());
+}
+
+TEST(ContainerInputTest, SizePrefix)
+{
+   const std::unordered_map<int, std::vector<std::string>> map{{1, {"a", "b"}}, {2, {}}};
+   std::stringstream ss;
+   ss << size_prefix << map << no_size_prefix << map;
+   EXPECT_EQ(0u, ss.str().find('2'));
+
+   std::unordered_map<int, std::vector<std::string>> prefixed, plain;
+   ss >> prefixed >> plain;
+   ASSERT_FALSE(ss.fail());
+   EXPECT_EQ(map, prefixed);
+   EXPECT_EQ(map, plain);
+
+   std::istringstream wrong_size("3<1,2>");
+   std::vector<int> vector;
+   wrong_size >> vector;
+   EXPECT_TRUE(wrong_size.fail());
+
+   // A bogus size prefix fails the read rather than reserving memory for it
+   std::istringstream huge_size("4000000000<1,2>");
+   vector.clear();
+   EXPECT_NO_THROW(huge_size >> vector);
+   EXPECT_TRUE(huge_size.fail());
+   std::istringstream huge_set_size("4000000000<1,2>");
+   std::unordered_set<int> set;
+   EXPECT_NO_THROW(huge_set_size >> set);
+   EXPECT_TRUE(huge_set_size.fail());
+   vector.clear();
+   EXPECT_FALSE(read_from_memory("99999999999999999<1,2>", vector));
+}
+
+TEST(ContainerInputTest, AssociativeContainersAndDeque)
+{
+   const std::map<std::string, std::vector<int>> map{{"a", {1, 2}}, {"b", {}}};
+   const std::multimap<int, std::string> multimap{{1, "x"}, {1, "y"}, {0, "z"}};
+   const std::multiset<int> multiset{3, 1, 3};
+   const std::unordered_set<std::string> set{"a", "bc"};
+   const std::unordered_multiset<int> unordered_multiset{2, 2, 5};
+   const std::unordered_multimap<int, char> unordered_multimap{{1, 'a'}, {1, 'b'}};
+   const std::deque<std::pair<int, double>> deque{{1, 0.5}, {2, -1}};
+
+   std::stringstream ss;
+   ss << map << multimap << size_prefix << multiset << set << no_size_prefix << unordered_multiset
+      << unordered_multimap << deque;
+   EXPECT_EQ(0u, ss.str().find("{(a,<1,2>),(b,<>)}{(0,z),(1,x),(1,y)}3{1,3,3}"));
+
+   std::map<std::string, std::vector<int>> map_read;
+   std::multimap<int, std::string> multimap_read;
+   std::multiset<int> multiset_read;
+   std::unordered_set<std::string> set_read;
+   std::unordered_multiset<int> unordered_multiset_read;
+   std::unordered_multimap<int, char> unordered_multimap_read;
+   std::deque<std::pair<int, double>> deque_read;
+   ss >> map_read >> multimap_read >> multiset_read >> set_read >> unordered_multiset_read >>
+      unordered_multimap_read >> deque_read;
+   ASSERT_FALSE(ss.fail());
+   EXPECT_EQ(map, map_read);
+   EXPECT_EQ(multimap, multimap_read);
+   EXPECT_EQ(multiset, multiset_read);
+   EXPECT_EQ(set, set_read);
+   EXPECT_EQ(unordered_multiset, unordered_multiset_read);
+   EXPECT_EQ(unordered_multimap, unordered_multimap_read);
+   EXPECT_EQ(deque, deque_read);
+
+   std::multimap<int, std::string> ordered;
+   ASSERT_TRUE(read_from_memory("{(2,b),(1,c),(2,a)}", ordered));
+   EXPECT_EQ((std::vector<std::pair<const int, std::string>>{{1, "c"}, {2, "b"}, {2, "a"}}),
+             (std::vector<std::pair<const int, std::string>>(ordered.begin(), ordered.end())));
+
+   std::stringstream binary;
+   write_binary(binary, map);
+   write_binary(binary, deque);
+   std::map<std::string, std::vector<int>> map_binary;
+   std::deque<std::pair<int, double>> deque_binary;
+   read_binary(binary, map_binary);
+   read_binary(binary, deque_binary);
+   ASSERT_FALSE(binary.fail());
+   EXPECT_EQ(map, map_binary);
+   EXPECT_EQ(deque, deque_binary);
+}
+
+TEST(ContainerInputTest, PerCallFormat)
+{
+   using semicolon_list = format<'[', ']', ';'>;
+   static_assert(semicolon_list::mDel == ';', "format characters are constants");
+   static_assert(container_format<std::vector<int>>::type::mLeft == '<', "default format");
+
+   const std::vector<std::pair<int, double>> vector{{1, 0.5}, {-2, 4}};
+   std::stringstream ss;
+   ss << with_format<semicolon_list>(vector);
+   EXPECT_EQ("[(1,0.5);(-2,4)]", ss.str());
+   EXPECT_EQ(ss.str(), to_string(with_format<semicolon_list>(vector)));
+
+   std::vector<std::pair<int, double>> scanned;
+   ss >> with_format<semicolon_list>(scanned);
+   ASSERT_FALSE(ss.fail());
+   EXPECT_EQ(vector, scanned);
+
+   std::istringstream nested("{<a,b>|<>}");
+   std::set<std::vector<std::string>> sets;
+   nested >> with_format<format<'{', '}', '|'>>(sets);
+   ASSERT_FALSE(nested.fail());
+   EXPECT_EQ((std::set<std::vector<std::string>>{{"a", "b"}, {}}), sets);
+}
+
+// boost::string_view values can only be read from memory
+static_assert(!is_scannable_container<std::vector<boost::string_view>>::value, "stream");
+static_assert(is_scannable_container<std::vector<boost::string_view>, memory_source>::value,
+              "memory");
+static_assert(is_scannable_container<std::vector<std::pair<int, boost::string_view>>,
+                                     memory_source>::value,
+              "memory");
+static_assert(refers_to_source<std::list<std::vector<std::pair<int, boost::string_view>>>>::value,
+              "nested");
+static_assert(!refers_to_source<std::vector<std::string>>::value, "strings are copied");
+
+TEST(ContainerInputTest, ReadFromMemory)
+{
+   std::vector<std::pair<int, std::string>> pairs;
+   ASSERT_TRUE(read_from_memory(" <(1,a),(2,bc)>", pairs));
+   EXPECT_EQ((std::vector<std::pair<int, std::string>>{{1, "a"}, {2, "bc"}}), pairs);
+
+   const std::string text = "{x,yz}";
+   std::set<boost::string_view> views;
+   ASSERT_TRUE(read_from_memory(text, views));
+   ASSERT_EQ(2u, views.size());
+   EXPECT_EQ(text.data() + 1, views.begin()->data());
+   std::vector<std::pair<int, boost::string_view>> keyed;
+   ASSERT_TRUE(read_from_memory("<(1,x),(2,yz)>", keyed));
+   EXPECT_EQ("yz", keyed[1].second);
+
+   std::vector<std::vector<int>> nested;
+   ASSERT_TRUE(read_from_memory("<<1>,<2,3>>", nested));
+   EXPECT_EQ((std::vector<std::vector<int>>{{1}, {2, 3}}), nested);
+
+   std::vector<int> vector;
+   EXPECT_FALSE(read_from_memory("2<1,2,3>", vector));
+}
+
+TEST(ContainerInputTest, ReadFromMappedFile)
+{
+   const std::string filename = "container_io_TEST.txt";
+   const std::unordered_map<int, double> map{{1, 0.5}, {-2, 3e10}};
+   ASSERT_TRUE(write_to_file(filename, map));
+
+   std::unordered_map<int, double> mapped;
+   EXPECT_TRUE(read_from_file(filename, mapped, read_mode::mapped));
+   EXPECT_EQ(map, mapped);
+   std::remove(filename.c_str());
+
+   EXPECT_FALSE(read_from_file(filename, mapped, read_mode::mapped));
+}
+
+TEST(ContainerInputTest, VisitNested)
+{
+   struct visitor : public container_visitor
+   {
+      std::string events;
+      void enter() { events += '['; }
+      void leave() { events += ']'; }
+      void operator()(const std::string& value) { events += value; }
+   } visitor;
+
+   std::istringstream is("<[a,b],[],[c]>");
+   visit_container<std::vector<std::list<std::string>>>(is, visitor);
+   ASSERT_FALSE(is.fail());
+   EXPECT_EQ("[[ab][][c]]", visitor.events);
+
+   std::istringstream invalid("<[a,b],[c]");
+   visit_container<std::vector<std::list<std::string>>>(invalid, visitor);
+   EXPECT_TRUE(invalid.fail());
+}
+
+TEST(ContainerInputTest, ForEachElement)
+{
+   long sum = 0;
+   std::istringstream is("{(1,<2,3>),(4,<>)}<<5>,2<6,7>>");
+   for_each_element<std::unordered_map<int, std::vector<int>>>(
+      is, [&sum](const std::pair<int, std::vector<int>>& pair) {
+         sum += pair.first;
+         for (const int value : pair.second)
+            sum += value;
+      });
+   for_each_element<std::vector<std::vector<int>>>(is, [&sum](const int value) { sum += value; });
+   ASSERT_FALSE(is.fail());
+   EXPECT_EQ(28, sum);
+}
+
+TEST(ContainerInputTest, ParallelRead)
+{
+   std::vector<std::pair<int, double>> vector;
+   for (int i = 0; i < 100000; ++i)
+      vector.emplace_back(i - 500, (i % 1000) / 4.0);
+   std::stringstream ss;
+   ss << size_prefix << vector;
+
+   std::vector<std::pair<int, double>> parallel;
+   ASSERT_TRUE(parallel_read_from_memory(ss.str(), parallel, 4));
+   EXPECT_EQ(vector, parallel);
+
+   std::string invalid = ss.str();
+   invalid.insert(invalid.size() / 2, ",");
+   EXPECT_FALSE(parallel_read_from_memory(invalid, parallel, 4));
+}
+
+TEST(FormatToTest, MatchesOperatorOutput)
+{
+   const auto expect_same_as_stream = [](const auto& value) {
+      std::ostringstream os;
+      os << value;
+      format_buffer buffer;
+      format_to(buffer, value);
+      EXPECT_EQ(os.str(), buffer.view().to_string());
+
+      std::string text;
+      format_to(std::back_inserter(text), value);
+      EXPECT_EQ(os.str(), text);
+   };
+
+   expect_same_as_stream(std::vector<int>{-1, 0, std::numeric_limits<int>::min()});
+   expect_same_as_stream(std::set<char>{'a', 'z'});
+   expect_same_as_stream(std::list<bool>{true, false});
+   expect_same_as_stream(std::vector<double>{0.1, -2.5e-7, 1e21, 123456789.0, 1.0 / 3, 100.0,
+                                             std::numeric_limits<double>::infinity()});
+   expect_same_as_stream(std::array<float, 2>{{1.5f, std::numeric_limits<float>::max()}});
+   expect_same_as_stream(std::vector<long double>{0.25L, 1e-300L});
+   expect_same_as_stream(std::make_pair(std::string("key"), std::vector<unsigned char>{'x'}));
+   expect_same_as_stream(std::unordered_map<long, std::forward_list<short>>{{7, {1, -2}}});
+   expect_same_as_stream(std::vector<datastructures::fixed_size_vector<int>>(
+      2, datastructures::fixed_size_vector<int>(2, 3)));
+}
+
+TEST(FormatToTest, StreamedValues)
+{
+   // Formatting a value of the same type from its operator<< does not clobber the outer text
+   const list_node third{3, nullptr}, second{2, &third}, first{1, &second};
+   format_buffer buffer;
+   format_to(buffer, first);
+   EXPECT_EQ("1->2->3", buffer.view());
+
+   // The formatting state set by one operator<< does not carry over to the next value
+   buffer.clear();
+   format_to(buffer, hex_value{255, true});
+   format_to(buffer, ' ');
+   format_to(buffer, hex_value{255, false});
+   EXPECT_EQ("00ff 255", buffer.view());
+}
+
+TEST(FormatToTest, WriteFormatted)
+{
+   std::vector<std::vector<unsigned long>> vector(1000, std::vector<unsigned long>{1, 20, 300});
+   std::ostringstream expected, written;
+   expected << size_prefix << vector;
+   written << size_prefix;
+   write_formatted(written, vector, 64);
+   EXPECT_EQ(expected.str(), written.str());
+
+   std::ostringstream expected_hex, written_hex;
+   expected_hex << std::hex << vector;
+   written_hex << std::hex;
+   write_formatted(written_hex, vector);
+   EXPECT_EQ(expected_hex.str(), written_hex.str());
+}
+
+TEST(FormatToTest, ToString)
+{
+   const std::vector<std::pair<int, std::string>> pairs{{1, "a"}, {-2, "bc"}};
+   std::ostringstream os;
+   os << pairs;
+   EXPECT_EQ(os.str(), to_string(pairs));
+   EXPECT_EQ("0.5", to_string(0.5));
+   EXPECT_EQ("abc", to_string("abc"));
+
+   EXPECT_EQ(os.str(), to_string_view(pairs));
+   EXPECT_EQ("42", to_string_view(42));
+
+   const small_string<8> short_text = to_small_string<8>(std::make_pair(1, 2));
+   EXPECT_TRUE(short_text.is_inline());
+   EXPECT_EQ("(1,2)", short_text.view());
+   const small_string<8> long_text = to_small_string<8>(pairs);
+   EXPECT_FALSE(long_text.is_inline());
+   EXPECT_EQ(os.str(), long_text.str());
+
+   // to_string is reentrant: operator<< can call it for values of the same type
+   const tree_node tree{1, {{2, {{3, {}}}}, {4, {}}}};
+   std::ostringstream tree_os;
+   tree_os << tree;
+   EXPECT_EQ("1[2[3]][4]", tree_os.str());
+   EXPECT_EQ(tree_os.str(), to_string(tree));
+}
+
+TEST(AsyncFileWriterTest, WritesInQueueOrder)
+{
+   const std::string filename = "async_file_writer_TEST.txt";
+   std::vector<std::future<bool>> results;
+   bool callback_result = false;
+   {
+      async_file_writer writer;
+      const auto file = writer.open(filename);
+      ASSERT_TRUE(file);
+      for (int i = 0; i < 100; ++i)
+         results.push_back(writer.write_value(*file, std::vector<int>{i, -i}));
+      writer.write(*file, "end\n", [&callback_result](const bool ok) { callback_result = ok; });
+      EXPECT_TRUE(writer.sync(*file).get());
+      EXPECT_TRUE(writer.close(*file).get());
+      EXPECT_FALSE(writer.write(*file, "closed").get());
+   }
+   for (std::future<bool>& result : results)
+      EXPECT_TRUE(result.get());
+   EXPECT_TRUE(callback_result);
+
+   std::ifstream ifs(filename);
+   std::vector<int> vector;
+   for (int i = 0; i < 100; ++i)
+   {
+      vector.clear();
+      ifs >> vector;
+      EXPECT_EQ((std::vector<int>{i, -i}), vector);
+   }
+   std::string end;
+   ifs >> end;
+   EXPECT_EQ("end", end);
+   std::remove(filename.c_str());
+
+   async_file_writer writer;
+   EXPECT_FALSE(writer.open("no_such_directory/file.txt"));
+}
+
+TEST(AsyncFileWriterTest, ClosedFileIds)
+{
+   const std::string closed_name = "async_file_writer_TEST_closed.txt";
+   const std::string reopened_name = "async_file_writer_TEST_reopened.txt";
+   {
+      async_file_writer writer;
+      const auto closed = writer.open(closed_name);
+      ASSERT_TRUE(closed);
+      EXPECT_TRUE(writer.close(*closed).get());
+
+      // The file opened next may get the descriptor and table entry of the closed one
+      const auto reopened = writer.open(reopened_name);
+      ASSERT_TRUE(reopened);
+      EXPECT_FALSE(writer.write(*closed, "stale\n").get());
+      EXPECT_FALSE(writer.flush(*closed).get());
+      EXPECT_FALSE(writer.close(*closed).get());
+      bool callback_result = true;
+      writer.write(*closed, "stale\n", [&callback_result](const bool ok) { callback_result = ok; });
+
+      // Exceptions thrown by callbacks do not stop the writer
+      writer.write(*reopened, "fresh\n", [](bool) { throw std::runtime_error("callback"); });
+      EXPECT_TRUE(writer.flush(*reopened).get());
+      EXPECT_FALSE(callback_result);
+   }
+   std::ifstream ifs(reopened_name);
+   std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+   EXPECT_EQ("fresh\n", text);
+   std::remove(closed_name.c_str());
+   std::remove(reopened_name.c_str());
+}
+
+TEST(BinaryIOTest, RoundTrip)
+{
+   const std::unordered_map<int, std::vector<std::pair<std::string, double>>> map{
+      {1, {{"a", 0.5}, {"", -1e300}}}, {2, {}}};
+   const std::forward_list<std::array<short, 2>> list{{{1, 2}}, {{-3, 4}}};
+   const std::vector<bool> bits{true, false, true};
+   datastructures::fixed_size_vector<long> fixed(3, -7);
+   std::stringstream ss;
+   write_binary(ss, map);
+   write_binary(ss, list);
+   write_binary(ss, bits);
+   write_binary(ss, fixed);
+
+   std::unordered_map<int, std::vector<std::pair<std::string, double>>> map_read;
+   std::forward_list<std::array<short, 2>> list_read;
+   std::vector<bool> bits_read;
+   datastructures::fixed_size_vector<long> fixed_read(0);
+   read_binary(ss, map_read);
+   read_binary(ss, list_read);
+   read_binary(ss, bits_read);
+   read_binary(ss, fixed_read);
+   ASSERT_FALSE(ss.fail());
+   EXPECT_EQ(map, map_read);
+   EXPECT_EQ(list, list_read);
+   EXPECT_EQ(bits, bits_read);
+   EXPECT_TRUE(std::equal(fixed.cbegin(), fixed.cend(), fixed_read.cbegin(), fixed_read.cend()));
+}
+
+TEST(BinaryIOTest, RejectsInvalidInput)
+{
+   std::stringstream ss;
+   write_binary(ss, std::vector<int>{1, 2, 3});
+   const std::string binary = ss.str();
+
+   std::vector<int> vector;
+   std::istringstream truncated(binary.substr(0, binary.size() - 1));
+   read_binary(truncated, vector);
+   EXPECT_TRUE(truncated.fail());
+
+   std::string wrong_version = binary;
+   ++wrong_version[4];
+   std::istringstream version(wrong_version);
+   read_binary(version, vector);
+   EXPECT_TRUE(version.fail());
+
+   std::array<int, 2> array;
+   std::istringstream too_long(binary);
+   read_binary(too_long, array);
+   EXPECT_TRUE(too_long.fail());
+}
+
+TEST(BinaryIOTest, ReadFromFile)
+{
+   const std::string filename = "binary_io_TEST.bin";
+   const std::vector<std::set<int>> sets{{1, 2}, {}, {-3}};
+   ASSERT_TRUE(write_binary_to_file(filename, sets));
+
+   std::vector<std::set<int>> sets_read;
+   EXPECT_TRUE(read_binary_from_file(filename, sets_read));
+   EXPECT_EQ(sets, sets_read);
+   std::remove(filename.c_str());
+}
+
+}   // end namespace test
+}   // end namespace io
+}   // end namespace utils
@@ -0,0 +1,71 @@
+
+#include <fixed_size_vector.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+
+//--------------------------------------------------------------------------------------------------
+
+namespace datastructures {
+namespace test {
+
+static_assert(sizeof(fixed_size_vector<int>) == sizeof(int*) + sizeof(std::size_t),
+              "a fixed_size_vector is a pointer and a size");
+
+TEST(FixedSizeVectorTest, HeapStorage)
+{
+   fixed_size_vector<std::string> vector(3, "abc");
+   vector[1] = "d";
+   EXPECT_EQ(3u, vector.size());
+   EXPECT_EQ("d", vector[1]);
+
+   fixed_size_vector<std::string> copy(vector);
+   EXPECT_TRUE(std::equal(vector.cbegin(), vector.cend(), copy.cbegin(), copy.cend()));
+
+   const std::string* data = copy.data();
+   fixed_size_vector<std::string> moved(std::move(copy));
+   EXPECT_EQ(data, moved.data());
+   EXPECT_EQ(0u, copy.size());
+
+   copy = moved;
+   moved = fixed_size_vector<std::string>(0);
+   EXPECT_EQ(0u, moved.size());
+   EXPECT_EQ("abc", copy[2]);
+
+   std::ostringstream os;
+   os << copy;
+   EXPECT_EQ("<abc,d,abc>", os.str());
+}
+
+TEST(FixedSizeVectorTest, InlineStorage)
+{
+   using small_vector = fixed_size_vector<std::shared_ptr<int>, 2>;
+   const auto value = std::make_shared<int>(1);
+   {
+      small_vector small(2, value);
+      const auto* inline_data = small.data();
+      EXPECT_LE(static_cast<const void*>(&small), static_cast<const void*>(inline_data));
+      EXPECT_GT(static_cast<const void*>(&small + 1), static_cast<const void*>(inline_data));
+      EXPECT_EQ(3, value.use_count());
+
+      small_vector moved(std::move(small));
+      EXPECT_EQ(0u, small.size());
+      EXPECT_EQ(3, value.use_count());
+
+      small_vector large(3, value);
+      EXPECT_EQ(6, value.use_count());
+      small = large;
+      large = std::move(moved);
+      EXPECT_EQ(3u, small.size());
+      EXPECT_EQ(2u, large.size());
+      EXPECT_EQ(6, value.use_count());
+   }
+   EXPECT_EQ(1, value.use_count());
+}
+
+}   // end namespace test
+}   // end namespace datastructures
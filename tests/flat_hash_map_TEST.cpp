@@ -0,0 +1,112 @@
+
+#include <algorithm/zip_map_values.hpp>
+#include <binary_io.hpp>
+#include <flat_hash_map.hpp>
+#include <utils_io.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------
+
+namespace datastructures {
+namespace test {
+
+TEST(FlatHashMapTest, MatchesUnorderedMap)
+{
+   flat_hash_map<std::uint64_t, std::string> map;
+   std::unordered_map<std::uint64_t, std::string> expected;
+   EXPECT_EQ(map.end(), map.find(1));
+   std::uint64_t state = 1;
+   for (int i = 0; i < 20000; ++i)
+   {
+      state = state * 6364136223846793005ull + 1442695040888963407ull;
+      const std::uint64_t key = (state >> 33) % 2000;
+      if (state % 3 == 0)
+      {
+         EXPECT_EQ(expected.erase(key), map.erase(key));
+      }
+      else
+      {
+         const auto inserted = map.emplace(key, std::to_string(i));
+         EXPECT_EQ(expected.emplace(key, std::to_string(i)).second, inserted.second);
+         EXPECT_EQ(key, inserted.first->first);
+      }
+   }
+   ASSERT_EQ(expected.size(), map.size());
+   EXPECT_LE(map.load_factor(), map.max_load_factor());
+   for (const auto& value : expected)
+      EXPECT_EQ(value.second, map.at(value.first));
+   EXPECT_EQ(expected.size(), static_cast<std::size_t>(std::distance(map.begin(), map.end())));
+   EXPECT_THROW(map.at(5000), std::out_of_range);
+
+   map[7] = "seven";
+   EXPECT_EQ("seven", map.find(7)->second);
+   EXPECT_FALSE(map.try_emplace(7, "other").second);
+   EXPECT_EQ(1u, map.count(7));
+
+   const flat_hash_map<std::uint64_t, std::string> copy(map);
+   EXPECT_EQ(map, copy);
+   flat_hash_map<std::uint64_t, std::string> moved(std::move(map));
+   EXPECT_EQ(copy, moved);
+   EXPECT_TRUE(map.empty());
+
+   for (auto it = moved.begin(); it != moved.end();)
+      it = it->first % 2 == 0 ? moved.erase(it) : std::next(it);
+   for (const auto& value : moved)
+      EXPECT_EQ(1u, value.first % 2);
+   const std::size_t capacity = moved.bucket_count();
+   moved.clear();
+   EXPECT_TRUE(moved.empty());
+   EXPECT_EQ(capacity, moved.bucket_count());
+   EXPECT_EQ(moved.end(), moved.find(7));
+}
+
+TEST(FlatHashMapTest, ContainerIO)
+{
+   const flat_hash_map<int, std::vector<int>> map{{1, {2, 3}}, {4, {}}};
+   std::stringstream ss;
+   ss << map;
+   flat_hash_map<int, std::vector<int>> read;
+   ss >> read;
+   ASSERT_FALSE(ss.fail());
+   EXPECT_EQ(map, read);
+
+   flat_hash_map<std::string, double> values;
+   ASSERT_TRUE(utils::io::read_from_memory("{(a,0.5),(b,-2)}", values));
+   EXPECT_EQ(0.5, values.at("a"));
+   EXPECT_EQ(-2, values.at("b"));
+
+   std::stringstream binary;
+   utils::io::write_binary(binary, values);
+   flat_hash_map<std::string, double> values_read;
+   utils::io::read_binary(binary, values_read);
+   EXPECT_EQ(values, values_read);
+}
+
+TEST(FlatHashMapTest, ZipMapValues)
+{
+   flat_hash_map<long, long> map1, map2;
+   for (long key = 0; key < 3 * static_cast<long>(utils::algo::detail::min_chunk_size); ++key)
+   {
+      map1.emplace(key, key);
+      map2.emplace(key, 2 * key);
+   }
+   const auto add = [](const long value1, const long value2) { return value1 + value2; };
+   flat_hash_map<long, long> zipped;
+   utils::algorithm::zip_map_values(map1, map2, add, zipped);
+   ASSERT_EQ(map1.size(), zipped.size());
+   EXPECT_EQ(30, zipped.at(10));
+   flat_hash_map<long, long> parallel;
+   utils::algorithm::zip_map_values(utils::algo::execution::par, map1, map2, add, parallel);
+   EXPECT_EQ(zipped, parallel);
+}
+
+}   // end namespace test
+}   // end namespace datastructures
@@ -3,6 +3,10 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+#include <system_error>
+#include <vector>
+
 
 //--------------------------------------------------------------------------------------------------
 
@@ -35,6 +39,33 @@ TEST(ForkTest, ForkTestNoTimeoutSubsequent)
                                 std::chrono::milliseconds(3000)));
 }
 
+TEST(ForkTest, ForkTestStatus)
+{
+   EXPECT_TRUE(fork_process("true", boost::none).success());
+   const process_status exited = fork_process("exit 3", boost::none);
+   ASSERT_TRUE(exited.exited());
+   EXPECT_EQ(3, exited.exit_status());
+   const process_status killed = fork_process("kill -9 $$", timeout_t(1000));
+   ASSERT_TRUE(killed.signaled());
+   EXPECT_EQ(SIGKILL, killed.signal());
+}
+
+TEST(ForkTest, RunProcessArgv)
+{
+   // Arguments are passed as is, without the shell interpreting them
+   EXPECT_TRUE(run_process(command{{"test", "$HOME", "=", "$HOME"}}, boost::none).success());
+   EXPECT_EQ(1, run_process(command{{"test", "a b", "=", "a"}}, boost::none).exit_status());
+
+   const command environment{{"sh", "-c", "test \"$VALUE\" = 42 && test \"$(pwd)\" = /"},
+                             std::vector<std::string>{"PATH=/usr/bin:/bin", "VALUE=42"},
+                             std::string("/")};
+   EXPECT_TRUE(run_process(environment, boost::none).success());
+
+   ASSERT_THROW(run_process(command{{"sleep", "2"}}, timeout_t(100)), process_timed_out);
+   ASSERT_THROW(run_process(command{{"no-such-program-on-the-path"}}, boost::none),
+                std::system_error);
+}
+
 }   // end namespace test
 }   // end namespace sys
 }   // end namespace utils
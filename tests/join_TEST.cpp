@@ -0,0 +1,101 @@
+
+#include <algorithm/join.hpp>
+#include <flat_hash_map.hpp>
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------
+
+namespace utils {
+namespace algorithm {
+namespace test {
+
+namespace {
+
+/// @brief Renders an optional value, or - if it is empty.
+template <typename T>
+std::string to_text(const boost::optional<const T&>& value)
+{
+   return value ? std::to_string(*value) : "-";
+}
+
+}   // end namespace
+
+TEST(JoinTest, HashJoins)
+{
+   const std::unordered_map<int, int> map1{{1, 10}, {2, 20}, {3, 30}};
+   const datastructures::flat_hash_map<int, double> map2{{2, 0.5}, {3, 1.5}, {4, 2.5}};
+
+   std::map<int, std::pair<int, double>> inner;
+   inner_join(map1, map2, [&inner](const int key, const int value1, const double value2) {
+      inner.emplace(key, std::make_pair(value1, value2));
+   });
+   EXPECT_EQ((std::map<int, std::pair<int, double>>{{2, {20, 0.5}}, {3, {30, 1.5}}}), inner);
+
+   std::map<int, std::string> left;
+   left_join(map1, map2, [&left](const int key, const int value1,
+                                 const boost::optional<const double&>& value2) {
+      left.emplace(key, std::to_string(value1) + (value2 ? "+" : "-"));
+   });
+   EXPECT_EQ((std::map<int, std::string>{{1, "10-"}, {2, "20+"}, {3, "30+"}}), left);
+
+   std::map<int, std::string> outer;
+   outer_join(map1, map2,
+              [&outer](const int key, const boost::optional<const int&>& value1,
+                       const boost::optional<const double&>& value2) {
+                 EXPECT_TRUE(outer.emplace(key, to_text(value1) + (value2 ? "+" : "-")).second);
+              });
+   EXPECT_EQ((std::map<int, std::string>{{1, "10-"}, {2, "20+"}, {3, "30+"}, {4, "-+"}}), outer);
+
+   const std::unordered_map<int, std::string> map3{{3, "c"}, {2, "b"}};
+   std::map<int, std::tuple<int, double, std::string>> zipped;
+   zip_maps(
+      [&zipped](const int key, const int value1, const double value2, const std::string& value3) {
+         zipped.emplace(key, std::make_tuple(value1, value2, value3));
+      },
+      map1, map2, map3);
+   EXPECT_EQ((std::map<int, std::tuple<int, double, std::string>>{
+                {2, std::make_tuple(20, 0.5, "b")}, {3, std::make_tuple(30, 1.5, "c")}}),
+             zipped);
+}
+
+TEST(JoinTest, MergeJoins)
+{
+   const std::vector<std::pair<int, char>> range1{{1, 'a'}, {2, 'b'}, {2, 'c'}, {5, 'd'}};
+   const std::vector<std::pair<int, int>> range2{{0, 0}, {2, 20}, {2, 21}, {5, 50}, {6, 60}};
+
+   std::vector<std::tuple<int, char, int>> inner;
+   merge_join(range1.begin(), range1.end(), range2.begin(), range2.end(),
+              [&inner](const int key, const char value1, const int value2) {
+                 inner.emplace_back(key, value1, value2);
+              });
+   EXPECT_EQ((std::vector<std::tuple<int, char, int>>{std::make_tuple(2, 'b', 20),
+                                                      std::make_tuple(2, 'b', 21),
+                                                      std::make_tuple(2, 'c', 20),
+                                                      std::make_tuple(2, 'c', 21),
+                                                      std::make_tuple(5, 'd', 50)}),
+             inner);
+
+   std::vector<std::string> outer;
+   merge_outer_join(range1.begin(), range1.end(), range2.begin(), range2.end(),
+                    [&outer](const int key, const boost::optional<const char&>& value1,
+                             const boost::optional<const int&>& value2) {
+                       outer.push_back(std::to_string(key) + (value1 ? *value1 : '-') +
+                                       to_text(value2));
+                    });
+   EXPECT_EQ((std::vector<std::string>{"0-0", "1a-", "2b20", "2b21", "2c20", "2c21", "5d50",
+                                       "6-60"}),
+             outer);
+}
+
+}   // end namespace test
+}   // end namespace algorithm
+}   // end namespace utils
@@ -0,0 +1,46 @@
+
+#include <logging.hpp>
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+
+//--------------------------------------------------------------------------------------------------
+
+namespace utils {
+namespace logging {
+namespace test {
+
+TEST(LoggingTest, WritesEnabledRecords)
+{
+   std::ostringstream os;
+   set_output(os);
+   UTILS_LOG_WARNING(module::io, "read " << 3 << " elements");
+   std::thread([] { UTILS_LOG_ERROR(module::threads, "from thread"); }).join();
+   flush();
+   EXPECT_NE(std::string::npos, os.str().find("[warning] [io] [thread "));
+   EXPECT_NE(std::string::npos, os.str().find("] read 3 elements\n"));
+   EXPECT_NE(std::string::npos, os.str().find("[error] [threads] "));
+
+   os.str("");
+   set_enabled_modules(enabled_modules() & ~module::io);
+   UTILS_LOG_WARNING(module::io, "disabled");
+   set_enabled_modules(~0u);
+   flush();
+   EXPECT_EQ("", os.str());
+   set_output(std::clog);
+}
+
+TEST(LoggingTest, CompilesOutLowerLevels)
+{
+   int evaluated = 0;
+   UTILS_LOG_DEBUG(module::general, ++evaluated);
+   EXPECT_EQ(UTILS_LOG_LEVEL <= UTILS_LOG_LEVEL_DEBUG ? 1 : 0, evaluated);
+}
+
+}   // end namespace test
+}   // end namespace logging
+}   // end namespace utils
@@ -1,5 +1,15 @@
 
+#include "algo_TEST.cpp"
+#include "container_io_TEST.cpp"
+#include "fixed_size_vector_TEST.cpp"
+#include "flat_hash_map_TEST.cpp"
 #include "fork_TEST.cpp"
+#include "join_TEST.cpp"
+#include "logging_TEST.cpp"
+#include "memory_resource_TEST.cpp"
+#include "process_pool_TEST.cpp"
+#include "simd_TEST.cpp"
+#include "zip_map_values_TEST.cpp"
 
 #include <gtest/gtest.h>
 
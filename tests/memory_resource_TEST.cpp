@@ -0,0 +1,160 @@
+
+#include <fixed_size_vector.hpp>
+#include <memory_resource.hpp>
+#include <utils_io.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------
+
+namespace utils {
+namespace memory {
+namespace test {
+
+namespace {
+
+template <typename T>
+using vector = std::vector<T, resource_allocator<T>>;
+
+using string = std::basic_string<char, std::char_traits<char>, resource_allocator<char>>;
+
+template <typename T>
+bool in_arena(const T* value, monotonic_arena& arena)
+{
+   return value->get_allocator().resource() == &arena;
+}
+
+/// @brief Counts its live instances. Its default constructor throws while s_throw is set.
+struct counted
+{
+   static int s_live;
+   static bool s_throw;
+
+   counted()
+   {
+      if (s_throw)
+         throw std::runtime_error("counted");
+      ++s_live;
+   }
+
+   ~counted()
+   {
+      --s_live;
+   }
+};
+
+int counted::s_live = 0;
+bool counted::s_throw = false;
+
+}   // end namespace
+
+static_assert(is_releasable<vector<std::pair<const int, string>>>::value, "arena-only value");
+static_assert(!is_releasable<vector<std::string>>::value, "std::string frees its memory");
+
+TEST(MemoryResourceTest, MonotonicArena)
+{
+   monotonic_arena arena(64);
+   const void* first = arena.allocate(24, 8);
+   const void* second = arena.allocate(100, 64);
+   EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(second) % 64);
+   EXPECT_NE(first, second);
+   EXPECT_EQ(124u, arena.allocated_bytes());
+   arena.release();
+   EXPECT_EQ(0u, arena.allocated_bytes());
+
+   {
+      const resource_scope scope(arena);
+      EXPECT_EQ(&arena, &current_resource());
+      vector<int> numbers{1, 2, 3};
+      EXPECT_TRUE(in_arena(&numbers, arena));
+   }
+   EXPECT_EQ(&new_delete_resource(), &current_resource());
+}
+
+TEST(MemoryResourceTest, BlockPool)
+{
+   block_pool pool(sizeof(std::list<int>::value_type) + 2 * sizeof(void*), 4);
+   std::list<int, resource_allocator<int>> list(pool);
+   for (int i = 0; i < 10; ++i)
+      list.push_back(i);
+   const int* node = &list.back();
+   list.pop_back();
+   list.push_back(9);
+   EXPECT_EQ(node, &list.back());
+
+   void* large = pool.allocate(4 * pool.block_size());
+   pool.deallocate(large, 4 * pool.block_size());
+
+   // Over-aligned requests are passed to the upstream resource, which honors the alignment
+   void* aligned = pool.allocate(16, 128);
+   EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(aligned) % 128);
+   pool.deallocate(aligned, 16, 128);
+   void* page = new_delete_resource().allocate(100, 4096);
+   EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(page) % 4096);
+   new_delete_resource().deallocate(page, 100, 4096);
+}
+
+TEST(MemoryResourceTest, ReadIntoArena)
+{
+   arena_snapshot<vector<vector<string>>> snapshot;
+   ASSERT_TRUE(io::read_from_memory("<<a,bc>,<>,<def>>", snapshot));
+   const auto& value = snapshot.value();
+   ASSERT_EQ(3u, value.size());
+   EXPECT_EQ("bc", value[0][1]);
+   EXPECT_TRUE(in_arena(&value, snapshot.arena()));
+   EXPECT_TRUE(in_arena(&value[2], snapshot.arena()));
+   EXPECT_TRUE(in_arena(&value[2][0], snapshot.arena()));
+   EXPECT_LT(0u, snapshot.arena().allocated_bytes());
+
+   // Through the container_istream_iterator
+   std::istringstream is("<<x>>");
+   const resource_scope scope(snapshot.arena());
+   vector<vector<string>> streamed;
+   is >> streamed;
+   ASSERT_FALSE(is.fail());
+   EXPECT_EQ("x", streamed[0][0]);
+   EXPECT_TRUE(in_arena(&streamed[0], snapshot.arena()));
+
+   arena_snapshot<vector<std::string>> strings;
+   ASSERT_TRUE(io::read_from_memory("<a,bc>", strings));
+   EXPECT_EQ("bc", strings.value()[1]);
+   strings.reset();
+   EXPECT_TRUE(strings.value().empty());
+
+   // A value whose construction throws in reset is not destroyed again
+   {
+      arena_snapshot<counted> snapshot;
+      EXPECT_EQ(1, counted::s_live);
+      counted::s_throw = true;
+      EXPECT_THROW(snapshot.reset(), std::runtime_error);
+      EXPECT_EQ(0, counted::s_live);
+      counted::s_throw = false;
+   }
+   EXPECT_EQ(0, counted::s_live);
+}
+
+TEST(MemoryResourceTest, FixedSizeVectorAllocator)
+{
+   monotonic_arena arena;
+   using arena_vector = datastructures::fixed_size_vector<double, 0, resource_allocator<double>>;
+   arena_vector numbers(10, 1.5, arena);
+   EXPECT_TRUE(in_arena(&numbers, arena));
+   EXPECT_EQ(15, datastructures::sum(numbers));
+
+   arena_vector copy(numbers);
+   EXPECT_EQ(&new_delete_resource(), copy.get_allocator().resource());
+   copy = std::move(numbers);
+   EXPECT_EQ(&new_delete_resource(), copy.get_allocator().resource());
+   EXPECT_EQ(1.5, copy[9]);
+}
+
+}   // end namespace test
+}   // end namespace memory
+}   // end namespace utils
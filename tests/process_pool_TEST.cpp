@@ -0,0 +1,66 @@
+
+#include <process_pool.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------
+
+namespace utils {
+namespace sys {
+namespace test {
+
+TEST(ProcessPoolTest, Statuses)
+{
+   const std::vector<process_job> jobs{{command{{"true"}}, boost::none},
+                                       {command::shell("exit 3"), boost::none},
+                                       {command::shell("kill -9 $$"), timeout_t(1000)}};
+   const std::vector<process_result> results = process_pool(2).run(jobs);
+   ASSERT_EQ(3u, results.size());
+   for (std::size_t job = 0; job < results.size(); ++job)
+   {
+      EXPECT_EQ(job, results[job].m_job);
+      ASSERT_FALSE(results[job].timed_out());
+   }
+   EXPECT_TRUE(results[0].m_status->success());
+   EXPECT_EQ(3, results[1].m_status->exit_status());
+   EXPECT_EQ(SIGKILL, results[2].m_status->signal());
+}
+
+TEST(ProcessPoolTest, ConcurrencyAndTimeouts)
+{
+   // The timed out job ends first, the others in two rounds of two
+   const std::vector<process_job> jobs{{command{{"sleep", "0.3"}}, boost::none},
+                                       {command::shell("sleep 5"), timeout_t(100)},
+                                       {command{{"sleep", "0.3"}}, boost::none},
+                                       {command{{"sleep", "0.3"}}, timeout_t(3000)}};
+   std::vector<std::size_t> order;
+   const auto start = std::chrono::steady_clock::now();
+   process_pool(2).run(jobs, [&order](const process_result& result) {
+      order.push_back(result.m_job);
+      EXPECT_EQ(result.m_job == 1, result.timed_out());
+   });
+   const auto duration = std::chrono::steady_clock::now() - start;
+   EXPECT_EQ((std::vector<std::size_t>{1, 0, 2, 3}), order);
+   EXPECT_GE(duration, std::chrono::milliseconds(600));
+   EXPECT_LT(duration, std::chrono::milliseconds(3000));
+}
+
+TEST(ProcessPoolTest, ThrowingCallback)
+{
+   const std::vector<process_job> jobs{{command{{"true"}}, boost::none},
+                                       {command{{"sleep", "5"}}, boost::none}};
+   const auto start = std::chrono::steady_clock::now();
+   EXPECT_THROW(process_pool(2).run(jobs,
+                                    [](const process_result&) { throw std::runtime_error("done"); }),
+                std::runtime_error);
+   EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(3000));
+}
+
+}   // end namespace test
+}   // end namespace sys
+}   // end namespace utils
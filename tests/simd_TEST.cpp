@@ -0,0 +1,124 @@
+
+#include <fixed_size_vector.hpp>
+#include <simd.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------
+
+namespace utils {
+namespace simd {
+namespace test {
+
+namespace {
+
+/// @brief Runs the kernels on sizes around the block size and checks them against plain loops.
+template <typename T>
+void expect_matches_loops()
+{
+   for (const std::size_t n : {std::size_t(1), lanes<T>() - 1, lanes<T>(), 5 * lanes<T>() + 3})
+   {
+      std::vector<T> a(n), b(n), out(n);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+         a[i] = static_cast<T>((i * 7) % 11) - 5;
+         b[i] = static_cast<T>((i * 3) % 5);
+      }
+      add(a.data(), b.data(), out.data(), n);
+      for (std::size_t i = 0; i < n; ++i)
+         EXPECT_EQ(a[i] + b[i], out[i]);
+      mul(a.data(), b.data(), out.data(), n);
+      for (std::size_t i = 0; i < n; ++i)
+         EXPECT_EQ(a[i] * b[i], out[i]);
+      max(a.data(), b.data(), out.data(), n);
+      for (std::size_t i = 0; i < n; ++i)
+         EXPECT_EQ(std::max(a[i], b[i]), out[i]);
+
+      std::vector<std::uint8_t> mask(n);
+      less(a.data(), b.data(), mask.data(), n);
+      for (std::size_t i = 0; i < n; ++i)
+         EXPECT_EQ(a[i] < b[i], mask[i] == 1);
+
+      EXPECT_EQ(std::accumulate(a.begin(), a.end(), T()), sum(a.data(), n));
+      EXPECT_EQ(*std::min_element(a.begin(), a.end()), min_value(a.data(), n));
+      EXPECT_EQ(*std::max_element(a.begin(), a.end()), max_value(a.data(), n));
+      EXPECT_EQ(std::inner_product(a.begin(), a.end(), b.begin(), T()), dot(a.data(), b.data(), n));
+
+      // In place
+      sub(a.data(), b.data(), a.data(), n);
+      add(a.data(), b.data(), a.data(), n);
+      copy(a.data(), out.data(), n);
+      EXPECT_EQ(a, out);
+      fill(out.data(), n, T(2));
+      EXPECT_EQ(std::vector<T>(n, T(2)), out);
+   }
+}
+
+}   // end namespace
+
+TEST(SimdTest, KernelsOnEachInstructionSet)
+{
+   for (const isa set : {isa::scalar, isa::avx2, isa::avx512})
+   {
+      if (set > detected_isa())
+         continue;
+      set_max_isa(set);
+      SCOPED_TRACE(to_string(active_isa()));
+      EXPECT_EQ(set, active_isa());
+      expect_matches_loops<float>();
+      expect_matches_loops<double>();
+      expect_matches_loops<std::int32_t>();
+      expect_matches_loops<std::int64_t>();
+   }
+   set_max_isa(isa::avx512);
+}
+
+TEST(SimdTest, FixedSizeVectorOperations)
+{
+   datastructures::fixed_size_vector<double> a(21, 1.5), b(21, 0.5);
+   EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a.data()) % alignment);
+   b[20] = 4;
+   a += b;
+   a *= b;
+   EXPECT_EQ(1, a[0]);
+   EXPECT_EQ(22, a[20]);
+   EXPECT_EQ(42, sum(a));
+   EXPECT_EQ(1, min_value(a));
+   EXPECT_EQ(22, max_value(a));
+   EXPECT_EQ(98, dot(a, b));
+   EXPECT_EQ(1, less(b, a)[3]);
+   EXPECT_EQ(0, equal(a, b)[20]);
+   a.fill(3);
+   a -= b;
+   EXPECT_EQ(2.5, a[0]);
+
+   datastructures::fixed_size_vector<std::int32_t, 4> small(3, 2);
+   small *= small;
+   EXPECT_EQ(12, sum(small));
+
+   // Types without kernels use plain loops
+   datastructures::fixed_size_vector<short> shorts(5, 3), ones(5, 1);
+   shorts[4] = -2;
+   shorts += ones;
+   shorts *= shorts;
+   EXPECT_EQ(65, sum(shorts));
+   EXPECT_EQ(1, min_value(shorts));
+   EXPECT_EQ(16, max_value(shorts));
+   EXPECT_EQ(65, dot(shorts, ones));
+   EXPECT_EQ(0, less(shorts, ones)[0]);
+   EXPECT_EQ(1, equal(shorts, ones)[4]);
+   shorts.fill(2);
+   shorts -= ones;
+   EXPECT_EQ(5, sum(shorts));
+   datastructures::fixed_size_vector<unsigned char> bytes(3, 7);
+   EXPECT_EQ(21, sum(bytes));
+}
+
+}   // end namespace test
+}   // end namespace simd
+}   // end namespace utils
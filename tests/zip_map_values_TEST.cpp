@@ -0,0 +1,66 @@
+
+#include <algorithm/zip_map_values.hpp>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+
+//--------------------------------------------------------------------------------------------------
+
+namespace utils {
+namespace algorithm {
+namespace test {
+
+TEST(ZipMapValuesTest, Sequential)
+{
+   const std::unordered_map<int, std::string> names{{1, "one"}, {2, "two"}};
+   const std::unordered_map<int, int> counts{{1, 3}, {2, 1}, {3, 7}};
+   const auto repeat = [](const std::string& name, const int count) {
+      std::string repeated;
+      for (int i = 0; i < count; ++i)
+         repeated += name;
+      return repeated;
+   };
+   const std::unordered_map<int, std::string> expected{{1, "oneoneone"}, {2, "two"}};
+   EXPECT_EQ(expected, zip_map_values(names, counts, repeat));
+
+   const std::function<std::string(const std::string&, const int&)> function = repeat;
+   EXPECT_EQ(expected, zip_map_values(names, counts, function));
+
+   // Into a caller-supplied map, which is cleared first
+   std::unordered_map<int, std::string> zipped{{5, "five"}};
+   zip_map_values(names, counts, repeat, zipped);
+   EXPECT_EQ(expected, zipped);
+
+   EXPECT_THROW(zip_map_values(counts, names, [](int, const std::string&) { return 0; }),
+                std::invalid_argument);
+}
+
+TEST(ZipMapValuesTest, Parallel)
+{
+   std::unordered_map<long, long> map1, map2;
+   for (long key = 0; key < 5 * static_cast<long>(algo::detail::min_chunk_size); ++key)
+   {
+      map1.emplace(key, key);
+      map2.emplace(key, 2 * key);
+   }
+   map2.emplace(-1, 0);
+   const auto add = [](const long value1, const long value2) { return value1 + value2; };
+   const auto expected = zip_map_values(map1, map2, add);
+   EXPECT_EQ(expected, zip_map_values(algo::execution::par, map1, map2, add));
+   std::unordered_map<long, long> zipped;
+   zip_map_values(algo::execution::seq, map1, map2, add, zipped);
+   EXPECT_EQ(expected, zipped);
+
+   map1.emplace(-2, 0);
+   EXPECT_THROW(zip_map_values(algo::execution::par, map1, map2, add, zipped),
+                std::invalid_argument);
+}
+
+}   // end namespace test
+}   // end namespace algorithm
+}   // end namespace utils